@@ -0,0 +1,326 @@
+// nar_conv.cpp and Chapter_4/Conversion.cpp do one static_cast at a time.
+// These kernels convert whole arrays (columns) at once, and say which elements didn't fit.
+//
+//  - double -> int32 / int64 with three modes:
+//        truncate: like static_cast (toward zero)
+//        round:    to nearest, ties to even (like std::nearbyint)
+//        saturate: truncate, but clamp too-big values to the min/max instead of flagging garbage
+//  - int8 / uint8 -> int32 widening (always fits)
+//  - int32 -> int8 / uint8 narrowing, clamped
+//  - float <-> double
+//
+// Each kernel returns how many elements were out of range (or NaN), and if you pass a mask
+// array it also sets mask[i] = 1 for each of those elements.
+// For truncate/round, an out-of-range element's output is the type's minimum value
+// (that's what the x86 instructions produce); for saturate it's the clamped value and NaN becomes 0.
+//
+// double -> int uses AVX2 or AVX-512 intrinsics when compiled for them (-mavx2, -mavx512f -mavx512dq),
+// with a scalar loop for the leftover elements. The integer narrowing/widening kernels are plain
+// branchless loops, which the compiler already turns into packed SIMD instructions at -O3.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+enum class Mode
+{
+    truncate,
+    round,
+    saturate,
+};
+
+// ---- double -> integer, one element (reference version, also used for the leftovers) ----
+
+template <typename Int>
+Int convertOne(double x, Mode mode, bool& outOfRange)
+{
+    constexpr double lowest{ static_cast<double>(std::numeric_limits<Int>::min()) };
+    // max()+1 is a power of two, so it's exact as a double (max() itself isn't for int64)
+    constexpr double tooBig{ -lowest };
+
+    const double r{ mode == Mode::round ? std::nearbyint(x) : std::trunc(x) };
+    outOfRange = !(r >= lowest && r < tooBig); // written this way so NaN counts as out of range
+
+    if (!outOfRange)
+        return static_cast<Int>(r);
+    if (mode != Mode::saturate)
+        return std::numeric_limits<Int>::min();
+    if (std::isnan(x))
+        return 0;
+    return r < 0 ? std::numeric_limits<Int>::min() : std::numeric_limits<Int>::max();
+}
+
+template <typename Int>
+std::size_t convertScalar(const double* in, Int* out, std::size_t n, Mode mode, std::uint8_t* mask)
+{
+    std::size_t bad{ 0 };
+    for (std::size_t i{ 0 }; i < n; ++i)
+    {
+        bool outOfRange{};
+        out[i] = convertOne<Int>(in[i], mode, outOfRange);
+        bad += outOfRange;
+        if (mask)
+            mask[i] = outOfRange;
+    }
+    return bad;
+}
+
+std::size_t toInt32(const double* in, std::int32_t* out, std::size_t n, Mode mode, std::uint8_t* mask = nullptr)
+{
+    std::size_t i{ 0 };
+    std::size_t bad{ 0 };
+
+#if defined(__AVX512F__)
+    const __m512d lo{ _mm512_set1_pd(-2147483648.0) };
+    const __m512d hi{ _mm512_set1_pd(2147483647.0) };
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512d x{ _mm512_loadu_pd(in + i) };
+        const __m512d r{ mode == Mode::round ? _mm512_roundscale_pd(x, _MM_FROUND_TO_NEAREST_INT)
+                                             : _mm512_roundscale_pd(x, _MM_FROUND_TO_ZERO) };
+        // One bit per lane: set if the lane fits (ordered compares are false for NaN)
+        const __mmask8 fits{ static_cast<__mmask8>(_mm512_cmp_pd_mask(r, lo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(r, hi, _CMP_LE_OQ)) };
+
+        __m256i converted{};
+        if (mode == Mode::saturate)
+        {
+            const __m512d clamped{ _mm512_min_pd(_mm512_max_pd(r, lo), hi) };
+            const __mmask8 isNumber{ _mm512_cmp_pd_mask(x, x, _CMP_ORD_Q) };
+            converted = _mm512_maskz_cvttpd_epi32(isNumber, clamped); // NaN lanes become 0
+        }
+        else
+        {
+            converted = _mm512_cvttpd_epi32(r);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), converted);
+
+        const unsigned badBits{ static_cast<unsigned>(~fits) & 0xFFu };
+        bad += static_cast<std::size_t>(__builtin_popcount(badBits));
+        if (mask)
+        {
+            for (std::size_t lane{ 0 }; lane < 8; ++lane)
+                mask[i + lane] = (badBits >> lane) & 1u;
+        }
+    }
+#elif defined(__AVX2__)
+    const __m256d lo{ _mm256_set1_pd(-2147483648.0) };
+    const __m256d hi{ _mm256_set1_pd(2147483647.0) };
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256d x{ _mm256_loadu_pd(in + i) };
+        const __m256d r{ mode == Mode::round ? _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+                                             : _mm256_round_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC) };
+        // All-ones in lanes that fit (ordered compares are false for NaN)
+        const __m256d fits{ _mm256_and_pd(_mm256_cmp_pd(r, lo, _CMP_GE_OQ), _mm256_cmp_pd(r, hi, _CMP_LE_OQ)) };
+
+        __m128i converted{};
+        if (mode == Mode::saturate)
+        {
+            const __m256d isNumber{ _mm256_cmp_pd(x, x, _CMP_ORD_Q) };
+            const __m256d clamped{ _mm256_and_pd(_mm256_min_pd(_mm256_max_pd(r, lo), hi), isNumber) }; // NaN lanes -> 0.0
+            converted = _mm256_cvttpd_epi32(clamped);
+        }
+        else
+        {
+            converted = _mm256_cvttpd_epi32(r);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), converted);
+
+        const unsigned badBits{ ~static_cast<unsigned>(_mm256_movemask_pd(fits)) & 0xFu };
+        bad += static_cast<std::size_t>(__builtin_popcount(badBits));
+        if (mask)
+        {
+            for (std::size_t lane{ 0 }; lane < 4; ++lane)
+                mask[i + lane] = (badBits >> lane) & 1u;
+        }
+    }
+#endif
+
+    return bad + convertScalar(in + i, out + i, n - i, mode, mask ? mask + i : nullptr);
+}
+
+std::size_t toInt64(const double* in, std::int64_t* out, std::size_t n, Mode mode, std::uint8_t* mask = nullptr)
+{
+    std::size_t i{ 0 };
+    std::size_t bad{ 0 };
+
+    // AVX2 has no double -> int64 instruction, only AVX-512DQ does
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+    const __m512d lo{ _mm512_set1_pd(-9223372036854775808.0) };
+    const __m512d tooBig{ _mm512_set1_pd(9223372036854775808.0) };
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512d x{ _mm512_loadu_pd(in + i) };
+        const __m512d r{ mode == Mode::round ? _mm512_roundscale_pd(x, _MM_FROUND_TO_NEAREST_INT)
+                                             : _mm512_roundscale_pd(x, _MM_FROUND_TO_ZERO) };
+        const __mmask8 fits{ static_cast<__mmask8>(_mm512_cmp_pd_mask(r, lo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(r, tooBig, _CMP_LT_OQ)) };
+
+        __m512i converted{ _mm512_cvttpd_epi64(r) };
+        if (mode == Mode::saturate)
+        {
+            const __mmask8 isNumber{ _mm512_cmp_pd_mask(x, x, _CMP_ORD_Q) };
+            const __mmask8 positive{ _mm512_cmp_pd_mask(r, _mm512_setzero_pd(), _CMP_GT_OQ) };
+            converted = _mm512_mask_mov_epi64(converted, static_cast<__mmask8>(~fits & positive), _mm512_set1_epi64(std::numeric_limits<std::int64_t>::max()));
+            converted = _mm512_maskz_mov_epi64(isNumber, converted);
+        }
+        _mm512_storeu_si512(out + i, converted);
+
+        const unsigned badBits{ static_cast<unsigned>(~fits) & 0xFFu };
+        bad += static_cast<std::size_t>(__builtin_popcount(badBits));
+        if (mask)
+        {
+            for (std::size_t lane{ 0 }; lane < 8; ++lane)
+                mask[i + lane] = (badBits >> lane) & 1u;
+        }
+    }
+#endif
+
+    return bad + convertScalar(in + i, out + i, n - i, mode, mask ? mask + i : nullptr);
+}
+
+// ---- Integer widening / narrowing ----
+
+void widen(const std::int8_t* in, std::int32_t* out, std::size_t n)
+{
+    for (std::size_t i{ 0 }; i < n; ++i)
+        out[i] = in[i];
+}
+
+void widen(const std::uint8_t* in, std::int32_t* out, std::size_t n)
+{
+    for (std::size_t i{ 0 }; i < n; ++i)
+        out[i] = in[i];
+}
+
+// Clamps to [Small's min, Small's max]. Branchless so the loop vectorizes.
+template <typename Small>
+std::size_t narrow(const std::int32_t* in, Small* out, std::size_t n, std::uint8_t* mask = nullptr)
+{
+    constexpr std::int32_t lo{ std::numeric_limits<Small>::min() };
+    constexpr std::int32_t hi{ std::numeric_limits<Small>::max() };
+
+    std::size_t bad{ 0 };
+    for (std::size_t i{ 0 }; i < n; ++i)
+    {
+        const std::int32_t clamped{ std::clamp(in[i], lo, hi) };
+        const bool outOfRange{ clamped != in[i] };
+        out[i] = static_cast<Small>(clamped);
+        bad += outOfRange;
+        if (mask)
+            mask[i] = outOfRange;
+    }
+    return bad;
+}
+
+// ---- float <-> double ----
+
+void toDouble(const float* in, double* out, std::size_t n)
+{
+    for (std::size_t i{ 0 }; i < n; ++i)
+        out[i] = in[i]; // every float fits in a double exactly
+}
+
+// Doubles beyond float's range become +-infinity; those are reported (infinities and NaNs that
+// were already in the input are not, since they convert faithfully)
+std::size_t toFloat(const double* in, float* out, std::size_t n, std::uint8_t* mask = nullptr)
+{
+    std::size_t bad{ 0 };
+    for (std::size_t i{ 0 }; i < n; ++i)
+    {
+        const float f{ static_cast<float>(in[i]) };
+        const bool overflowed{ std::isinf(f) && std::isfinite(in[i]) };
+        out[i] = f;
+        bad += overflowed;
+        if (mask)
+            mask[i] = overflowed;
+    }
+    return bad;
+}
+
+// ---- Checks and benchmark ----
+
+template <typename Fn>
+double gigabytesPerSecond(std::size_t bytes, Fn fn)
+{
+    constexpr int repeats{ 10 };
+    const auto start{ std::chrono::steady_clock::now() };
+    for (int r{ 0 }; r < repeats; ++r)
+        fn();
+    const std::chrono::duration<double> seconds{ std::chrono::steady_clock::now() - start };
+    return static_cast<double>(bytes) * repeats / seconds.count() / 1e9;
+}
+
+int main()
+{
+    // nar_conv.cpp's example, in bulk
+    const std::vector<double> few{ 5.0, 2.5, -2.5, 3.7, 1e10, -1e300, std::nan(""), 2147483647.4 };
+    std::vector<std::int32_t> ints(few.size());
+    std::vector<std::uint8_t> mask(few.size());
+
+    for (Mode mode : { Mode::truncate, Mode::round, Mode::saturate })
+    {
+        const std::size_t bad{ toInt32(few.data(), ints.data(), few.size(), mode, mask.data()) };
+        for (std::size_t i{ 0 }; i < few.size(); ++i)
+            std::cout << ints[i] << (mask[i] ? "! " : " ");
+        std::cout << "(" << bad << " out of range)\n";
+    }
+
+    // Random column with a sprinkle of bad values, checked against the one-at-a-time version
+    constexpr std::size_t n{ 1 << 22 };
+    std::mt19937_64 mt{ 3 };
+    std::uniform_real_distribution<double> dist{ -3e9, 3e9 };
+    std::vector<double> column(n);
+    for (double& x : column)
+        x = dist(mt);
+    column[10] = std::nan("");
+    column[11] = std::numeric_limits<double>::infinity();
+
+    std::vector<std::int32_t> out32(n);
+    std::vector<std::int64_t> out64(n);
+    std::vector<std::uint8_t> columnMask(n);
+
+    bool ok{ true };
+    for (Mode mode : { Mode::truncate, Mode::round, Mode::saturate })
+    {
+        toInt32(column.data(), out32.data(), n, mode, columnMask.data());
+        toInt64(column.data(), out64.data(), n, mode);
+        for (std::size_t i{ 0 }; i < n; ++i)
+        {
+            bool outOfRange{};
+            ok = ok && out32[i] == convertOne<std::int32_t>(column[i], mode, outOfRange) && columnMask[i] == outOfRange;
+            ok = ok && out64[i] == convertOne<std::int64_t>(column[i], mode, outOfRange);
+        }
+    }
+    std::cout << "matches scalar reference: " << std::boolalpha << ok << "\n\n";
+
+    std::vector<std::int8_t> small(n);
+    std::vector<float> floats(n);
+    volatile std::int32_t sink{};
+
+    std::cout << "static_cast<int> loop: "
+              << gigabytesPerSecond(n * 8, [&] {
+                     for (std::size_t i{ 0 }; i < n; ++i)
+                         out32[i] = static_cast<std::int32_t>(column[i]); // UB for the out-of-range ones, just here for speed
+                     sink = out32[n / 2];
+                 })
+              << " GB/s\n";
+    std::cout << "toInt32 truncate:      " << gigabytesPerSecond(n * 8, [&] { toInt32(column.data(), out32.data(), n, Mode::truncate); }) << " GB/s\n";
+    std::cout << "toInt32 saturate+mask: " << gigabytesPerSecond(n * 8, [&] { toInt32(column.data(), out32.data(), n, Mode::saturate, columnMask.data()); }) << " GB/s\n";
+    std::cout << "toInt64 round:         " << gigabytesPerSecond(n * 8, [&] { toInt64(column.data(), out64.data(), n, Mode::round); }) << " GB/s\n";
+    std::cout << "int32 -> int8 narrow:  " << gigabytesPerSecond(n * 4, [&] { narrow(out32.data(), small.data(), n); }) << " GB/s\n";
+    std::cout << "int8 -> int32 widen:   " << gigabytesPerSecond(n, [&] { widen(small.data(), out32.data(), n); }) << " GB/s\n";
+    std::cout << "double -> float:       " << gigabytesPerSecond(n * 8, [&] { toFloat(column.data(), floats.data(), n); }) << " GB/s\n";
+    std::cout << "float -> double:       " << gigabytesPerSecond(n * 4, [&] { toDouble(floats.data(), column.data(), n); }) << " GB/s\n";
+
+    return 0;
+}
@@ -0,0 +1,352 @@
+// max(int&, int&) in quiz_q1.cpp compares two values. This file does the same thing for whole
+// arrays: max, min, min+max together, argmax and argmin, for int and double arrays.
+//
+// Rules (same as NumPy's, so results are predictable):
+//  - if a double array contains a NaN, max/min return NaN and argmax/argmin return the index of the first NaN
+//  - ties go to the FIRST index
+//  - arrays must not be empty
+//
+// The inner loops use AVX2 when compiled with -mavx2 (8 ints or 4 doubles per instruction),
+// otherwise a plain loop with 4 independent accumulators so the CPU can overlap the work.
+// Arrays bigger than parallelThreshold are split across threads.
+//
+// argmax is done as "find the max value, then find its first index". The second pass stops at
+// the first hit, and it keeps the fast vector max loop free of index bookkeeping.
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath> // for std::isnan
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+int& max(int& x, int& y)
+{
+    return x > y ? x : y;
+}
+
+template <typename T>
+struct MinMax
+{
+    T min{};
+    T max{};
+};
+
+constexpr std::size_t parallelThreshold{ 1 << 20 }; // below this, starting threads costs more than it saves
+
+// How many chunks (threads) arrays of parallelThreshold or more are split into. main() sets it to
+// 4 for its checks, so the threaded code gets tested on any machine.
+unsigned g_numThreads{ std::max(1u, std::thread::hardware_concurrency()) };
+
+template <typename T>
+bool isNaN(T value)
+{
+    return value != value; // only true for NaN (integers are never NaN)
+}
+
+// Scalar fallback. 4 accumulators so each step doesn't wait on the previous one.
+// wantMin/wantMax are template arguments so we don't pay for the half we don't need.
+template <bool wantMin, bool wantMax, typename T>
+MinMax<T> scanScalar(const T* data, std::size_t n, bool& sawNaN)
+{
+    T lo[4]{ data[0], data[0], data[0], data[0] };
+    T hi[4]{ data[0], data[0], data[0], data[0] };
+    bool nan{ false };
+
+    std::size_t i{ 0 };
+    for (; i + 4 <= n; i += 4)
+    {
+        for (std::size_t k{ 0 }; k < 4; ++k)
+        {
+            const T x{ data[i + k] };
+            if constexpr (wantMin)
+                lo[k] = (x < lo[k]) ? x : lo[k];
+            if constexpr (wantMax)
+                hi[k] = (x > hi[k]) ? x : hi[k];
+            nan |= isNaN(x);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        lo[0] = (data[i] < lo[0]) ? data[i] : lo[0];
+        hi[0] = (data[i] > hi[0]) ? data[i] : hi[0];
+        nan |= isNaN(data[i]);
+    }
+
+    sawNaN = nan;
+    return { *std::min_element(lo, lo + 4), *std::max_element(hi, hi + 4) };
+}
+
+#ifdef __AVX2__
+template <bool wantMin, bool wantMax>
+MinMax<int> scan(const int* data, std::size_t n, bool& sawNaN)
+{
+    sawNaN = false;
+    if (n < 16)
+        return scanScalar<wantMin, wantMax>(data, n, sawNaN);
+
+    __m256i lo{ _mm256_set1_epi32(data[0]) };
+    __m256i hi{ lo };
+
+    std::size_t i{ 0 };
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)) };
+        if constexpr (wantMin)
+            lo = _mm256_min_epi32(lo, x);
+        if constexpr (wantMax)
+            hi = _mm256_max_epi32(hi, x);
+    }
+
+    alignas(32) int loLanes[8];
+    alignas(32) int hiLanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(loLanes), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(hiLanes), hi);
+
+    MinMax<int> result{ *std::min_element(loLanes, loLanes + 8), *std::max_element(hiLanes, hiLanes + 8) };
+    for (; i < n; ++i)
+    {
+        result.min = std::min(result.min, data[i]);
+        result.max = std::max(result.max, data[i]);
+    }
+    return result;
+}
+
+template <bool wantMin, bool wantMax>
+MinMax<double> scan(const double* data, std::size_t n, bool& sawNaN)
+{
+    if (n < 8)
+        return scanScalar<wantMin, wantMax>(data, n, sawNaN);
+
+    __m256d lo{ _mm256_set1_pd(data[0]) };
+    __m256d hi{ lo };
+    __m256d nan{ _mm256_setzero_pd() };
+
+    std::size_t i{ 0 };
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256d x{ _mm256_loadu_pd(data + i) };
+        if constexpr (wantMin)
+            lo = _mm256_min_pd(lo, x);
+        if constexpr (wantMax)
+            hi = _mm256_max_pd(hi, x);
+        nan = _mm256_or_pd(nan, _mm256_cmp_pd(x, x, _CMP_UNORD_Q)); // all-ones in lanes that saw a NaN
+    }
+
+    alignas(32) double loLanes[4];
+    alignas(32) double hiLanes[4];
+    _mm256_store_pd(loLanes, lo);
+    _mm256_store_pd(hiLanes, hi);
+    sawNaN = _mm256_movemask_pd(nan) != 0;
+
+    MinMax<double> result{ *std::min_element(loLanes, loLanes + 4), *std::max_element(hiLanes, hiLanes + 4) };
+    for (; i < n; ++i)
+    {
+        result.min = (data[i] < result.min) ? data[i] : result.min;
+        result.max = (data[i] > result.max) ? data[i] : result.max;
+        sawNaN |= isNaN(data[i]);
+    }
+    return result;
+}
+#else
+template <bool wantMin, bool wantMax, typename T>
+MinMax<T> scan(const T* data, std::size_t n, bool& sawNaN)
+{
+    return scanScalar<wantMin, wantMax>(data, n, sawNaN);
+}
+#endif
+
+// Runs fn(begin, count) on one chunk per thread and returns the per-chunk results in order
+template <typename R, typename Fn>
+std::vector<R> forEachChunk(std::size_t n, Fn fn)
+{
+    const std::size_t numThreads{ std::max(1u, g_numThreads) };
+    const std::size_t chunk{ (n + numThreads - 1) / numThreads };
+
+    std::vector<R> results(numThreads);
+    std::vector<std::thread> threads{};
+    for (std::size_t t{ 0 }; t < numThreads; ++t)
+    {
+        const std::size_t begin{ std::min(n, t * chunk) };
+        const std::size_t count{ std::min(chunk, n - begin) };
+        if (count > 0)
+            threads.emplace_back([&results, fn, t, begin, count] { results[t] = fn(begin, count); });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    results.resize(threads.size());
+    return results;
+}
+
+template <bool wantMin, bool wantMax, typename T>
+MinMax<T> reduce(const T* data, std::size_t n, bool& sawNaN)
+{
+    assert(n > 0 && "can't take the max of an empty array");
+
+    if (n < parallelThreshold)
+        return scan<wantMin, wantMax>(data, n, sawNaN);
+
+    struct Partial
+    {
+        MinMax<T> value{};
+        bool nan{ false };
+    };
+
+    const std::vector<Partial> parts{ forEachChunk<Partial>(n, [data](std::size_t begin, std::size_t count) {
+        Partial part{};
+        part.value = scan<wantMin, wantMax>(data + begin, count, part.nan);
+        return part;
+    }) };
+
+    MinMax<T> result{ parts[0].value };
+    sawNaN = false;
+    for (const Partial& part : parts)
+    {
+        result.min = std::min(result.min, part.value.min);
+        result.max = std::max(result.max, part.value.max);
+        sawNaN |= part.nan;
+    }
+    return result;
+}
+
+template <typename T>
+T maxValue(const T* data, std::size_t n)
+{
+    bool sawNaN{ false };
+    const T result{ reduce<false, true>(data, n, sawNaN).max };
+    return sawNaN ? std::numeric_limits<T>::quiet_NaN() : result;
+}
+
+template <typename T>
+T minValue(const T* data, std::size_t n)
+{
+    bool sawNaN{ false };
+    const T result{ reduce<true, false>(data, n, sawNaN).min };
+    return sawNaN ? std::numeric_limits<T>::quiet_NaN() : result;
+}
+
+template <typename T>
+MinMax<T> minMax(const T* data, std::size_t n)
+{
+    bool sawNaN{ false };
+    const MinMax<T> result{ reduce<true, true>(data, n, sawNaN) };
+    if (sawNaN)
+        return { std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::quiet_NaN() };
+    return result;
+}
+
+// Index of the first element equal to target (or the first NaN if target is NaN)
+template <typename T>
+std::size_t firstIndexOf(const T* data, std::size_t n, T target)
+{
+    auto matches{ [target](T x) { return isNaN(target) ? isNaN(x) : x == target; } };
+
+    if (n < parallelThreshold)
+        return static_cast<std::size_t>(std::find_if(data, data + n, matches) - data);
+
+    const std::vector<std::size_t> hits{ forEachChunk<std::size_t>(n, [&](std::size_t begin, std::size_t count) {
+        const T* hit{ std::find_if(data + begin, data + begin + count, matches) };
+        return hit == data + begin + count ? n : static_cast<std::size_t>(hit - data);
+    }) };
+
+    // A chunk that found nothing returns n, so the smallest result is the first hit (or n if there's none)
+    return *std::min_element(hits.begin(), hits.end());
+}
+
+template <typename T>
+std::size_t argMax(const T* data, std::size_t n)
+{
+    return firstIndexOf(data, n, maxValue(data, n));
+}
+
+template <typename T>
+std::size_t argMin(const T* data, std::size_t n)
+{
+    return firstIndexOf(data, n, minValue(data, n));
+}
+
+// ---- Benchmark ----
+
+template <typename Fn>
+double gigabytesPerSecond(std::size_t bytes, Fn fn)
+{
+    constexpr int repeats{ 10 };
+    const auto start{ std::chrono::steady_clock::now() };
+    for (int r{ 0 }; r < repeats; ++r)
+        fn();
+    const std::chrono::duration<double> seconds{ std::chrono::steady_clock::now() - start };
+    return static_cast<double>(bytes) * repeats / seconds.count() / 1e9;
+}
+
+template <typename T>
+void benchmark(const char* typeName, const std::vector<T>& values)
+{
+    const T* data{ values.data() };
+    const std::size_t n{ values.size() };
+    const std::size_t bytes{ n * sizeof(T) };
+    volatile double sink{}; // keeps the optimizer from throwing the results away
+
+    std::cout << typeName << " x " << n << ":\n";
+    std::cout << "  std::max_element " << gigabytesPerSecond(bytes, [&] { sink = *std::max_element(data, data + n); }) << " GB/s\n";
+    std::cout << "  maxValue         " << gigabytesPerSecond(bytes, [&] { sink = maxValue(data, n); }) << " GB/s\n";
+    std::cout << "  minMax           " << gigabytesPerSecond(bytes, [&] { sink = minMax(data, n).max; }) << " GB/s\n";
+    std::cout << "  argMax           " << gigabytesPerSecond(bytes, [&] { sink = static_cast<double>(argMax(data, n)); }) << " GB/s\n";
+}
+
+int main()
+{
+    int x{ 5 };
+    int y{ 6 };
+    std::cout << max(x, y) << '\n'; // 6
+
+    // Ties go to the first index, NaN wins over everything
+    const std::vector<int> ints{ 3, 9, 1, 9, -4 };
+    std::cout << "argMax " << argMax(ints.data(), ints.size()) << ", argMin " << argMin(ints.data(), ints.size()) << '\n'; // 1, 4
+
+    const std::vector<double> doubles{ 1.5, std::nan(""), 8.0, std::nan("") };
+    std::cout << "max " << maxValue(doubles.data(), doubles.size()) << ", argMax " << argMax(doubles.data(), doubles.size()) << '\n'; // nan, 1
+
+    constexpr std::size_t n{ 1 << 24 };
+    std::mt19937 mt{ 1 };
+    std::vector<int> bigInts(n);
+    std::vector<double> bigDoubles(n);
+    for (std::size_t i{ 0 }; i < n; ++i)
+    {
+        bigInts[i] = static_cast<int>(mt());
+        bigDoubles[i] = static_cast<double>(bigInts[i]) * 0.5;
+    }
+
+    // Sanity check against the standard library
+    const bool ok{ maxValue(bigInts.data(), n) == *std::max_element(bigInts.begin(), bigInts.end())
+                   && argMin(bigDoubles.data(), n) == static_cast<std::size_t>(std::min_element(bigDoubles.begin(), bigDoubles.end()) - bigDoubles.begin()) };
+    std::cout << "matches std::max_element/min_element: " << std::boolalpha << ok << '\n';
+
+    // The threaded path, with the answers in later chunks than the first
+    const unsigned cores{ g_numThreads };
+    g_numThreads = 4;
+    const std::size_t quarter{ n / 4 };
+    std::vector<int> planted(n, 0);
+    planted[3 * quarter + 5] = 7;  // max in the last chunk
+    planted[2 * quarter] = -7;     // min at the very start of the third chunk
+    planted[3 * quarter + 9] = -7; // a later tie, which must lose
+    std::vector<double> withNaN(n, 1.0);
+    withNaN[quarter + 1] = std::nan(""); // argMax of a NaN array is the first NaN
+    const bool threadedOk{ argMax(planted.data(), n) == 3 * quarter + 5 && argMin(planted.data(), n) == 2 * quarter
+                           && argMax(withNaN.data(), n) == quarter + 1 && firstIndexOf(planted.data(), n, 42) == n };
+    g_numThreads = cores;
+    std::cout << "threaded argMax/argMin find hits in later chunks: " << threadedOk << "\n\n";
+
+    benchmark("int", bigInts);
+    benchmark("double", bigDoubles);
+
+    return 0;
+}
@@ -0,0 +1,317 @@
+// sort2() in quiz_q5.cpp does `if (x > y) std::swap(x, y);`.
+// On random data the CPU can't guess that branch, so it mispredicts about half the time.
+//
+// A sorting network is a fixed list of compare-exchange steps (i, j) that sorts any input.
+// The steps never depend on the data, so each one can be done without a branch:
+//     x = min(x, y); y = max(old x, y);   -> compiles to cmov / minps / pminsd
+//
+// Here the list of steps for each N (2 to 32) is generated at compile time with Batcher's
+// merge-exchange algorithm (Knuth, TAOCP vol. 3, algorithm 5.2.2M), then fully unrolled.
+// There's also a "many arrays at once" version: with the arrays stored side by side
+// (column k holds array k), each step is one SIMD min and one SIMD max across 8 arrays.
+//
+// Build with -O2 (add -mavx2 for the AVX2 batch path).
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <utility> // for std::index_sequence
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// The branchy original, for comparison
+void sort2(int& x, int& y)
+{
+    if (x > y)
+        std::swap(x, y);
+}
+
+struct Comparator
+{
+    std::size_t i{};
+    std::size_t j{};
+};
+
+// Batcher's merge exchange. Calls step(i, j) for every compare-exchange, in order.
+template <typename Step>
+constexpr void batcher(std::size_t n, Step step)
+{
+    if (n < 2)
+        return;
+
+    std::size_t t{ 1 };
+    while ((std::size_t{ 1 } << t) < n)
+        ++t;
+
+    for (std::size_t p{ std::size_t{ 1 } << (t - 1) }; p > 0; p >>= 1)
+    {
+        std::size_t q{ std::size_t{ 1 } << (t - 1) };
+        std::size_t r{ 0 };
+        std::size_t d{ p };
+        while (d > 0)
+        {
+            for (std::size_t i{ 0 }; i + d < n; ++i)
+            {
+                if ((i & p) == r)
+                    step(i, i + d);
+            }
+            d = q - p;
+            q >>= 1;
+            r = p;
+        }
+    }
+}
+
+constexpr std::size_t comparatorCount(std::size_t n)
+{
+    std::size_t count{ 0 };
+    batcher(n, [&count](std::size_t, std::size_t) { ++count; });
+    return count;
+}
+
+template <std::size_t N>
+constexpr auto makeNetwork()
+{
+    std::array<Comparator, comparatorCount(N)> network{};
+    std::size_t k{ 0 };
+    batcher(N, [&](std::size_t i, std::size_t j) { network[k++] = { i, j }; });
+    return network;
+}
+
+// One network per N, built by the compiler
+template <std::size_t N>
+inline constexpr auto sortingNetwork{ makeNetwork<N>() };
+
+// Branchless compare-exchange: after this, a <= b
+template <typename T>
+inline void compareExchange(T& a, T& b)
+{
+    const T x{ a };
+    const T y{ b };
+    a = (y < x) ? y : x; // min: with a ternary on plain values, compilers emit cmov/minss instead of a jump
+    b = (y < x) ? x : y; // max
+}
+
+// Key/value version: orders by key, value comes along. Equal keys are left as they are.
+template <typename K, typename V>
+struct KeyValue
+{
+    K key{};
+    V value{};
+};
+
+template <typename K, typename V>
+inline void compareExchange(KeyValue<K, V>& a, KeyValue<K, V>& b)
+{
+    const KeyValue<K, V> x{ a };
+    const KeyValue<K, V> y{ b };
+    const bool swap{ y.key < x.key };
+    a.key = swap ? y.key : x.key;
+    a.value = swap ? y.value : x.value;
+    b.key = swap ? x.key : y.key;
+    b.value = swap ? x.value : y.value;
+}
+
+template <std::size_t N, typename T, std::size_t... K>
+inline void applyNetwork(T* data, std::index_sequence<K...>)
+{
+    // Fold expression: expands to one compareExchange per comparator, no loop left at runtime
+    (compareExchange(data[sortingNetwork<N>[K].i], data[sortingNetwork<N>[K].j]), ...);
+}
+
+// Sort exactly N elements. Note: for floats, NaNs end up in unspecified places (like std::sort).
+template <std::size_t N, typename T>
+inline void networkSort(T* data)
+{
+    static_assert(N >= 2 && N <= 32, "networks are generated for N = 2..32");
+    applyNetwork<N>(data, std::make_index_sequence<sortingNetwork<N>.size()>{});
+}
+
+// Sort many arrays of N at once.
+// Layout: element e of array a is at data[e * lanes + a], with lanes = 8.
+// So row e holds element e of 8 different arrays, and each comparator is one vector min + max.
+constexpr std::size_t lanes{ 8 };
+
+template <typename T>
+inline void compareExchangeLanes(T* rowA, T* rowB)
+{
+    for (std::size_t lane{ 0 }; lane < lanes; ++lane)
+        compareExchange(rowA[lane], rowB[lane]);
+}
+
+#ifdef __AVX2__
+template <>
+inline void compareExchangeLanes<int>(int* rowA, int* rowB)
+{
+    const __m256i a{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowA)) };
+    const __m256i b{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowB)) };
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rowA), _mm256_min_epi32(a, b));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rowB), _mm256_max_epi32(a, b));
+}
+
+template <>
+inline void compareExchangeLanes<float>(float* rowA, float* rowB)
+{
+    const __m256 a{ _mm256_loadu_ps(rowA) };
+    const __m256 b{ _mm256_loadu_ps(rowB) };
+    _mm256_storeu_ps(rowA, _mm256_min_ps(a, b));
+    _mm256_storeu_ps(rowB, _mm256_max_ps(a, b));
+}
+#endif
+
+template <std::size_t N, typename T, std::size_t... K>
+inline void applyNetworkLanes(T* block, std::index_sequence<K...>)
+{
+    (compareExchangeLanes(block + sortingNetwork<N>[K].i * lanes, block + sortingNetwork<N>[K].j * lanes), ...);
+}
+
+// block holds N * 8 values: 8 arrays of N, interleaved as described above
+template <std::size_t N, typename T>
+inline void networkSortLanes(T* block)
+{
+    applyNetworkLanes<N>(block, std::make_index_sequence<sortingNetwork<N>.size()>{});
+}
+
+// ---- Benchmark ----
+
+enum class Pattern
+{
+    random,
+    sorted,
+    reversed,
+    allEqual,
+    organPipe, // 0 1 2 ... 2 1 0
+};
+
+std::string_view patternName(Pattern pattern)
+{
+    switch (pattern)
+    {
+    case Pattern::random:    return "random";
+    case Pattern::sorted:    return "sorted";
+    case Pattern::reversed:  return "reversed";
+    case Pattern::allEqual:  return "all equal";
+    case Pattern::organPipe: return "organ pipe";
+    default:                 return "???";
+    }
+}
+
+std::vector<int> makeInput(Pattern pattern, std::size_t n, std::size_t numArrays)
+{
+    std::mt19937 mt{ 42 };
+    std::vector<int> data(n * numArrays);
+    for (std::size_t a{ 0 }; a < numArrays; ++a)
+    {
+        for (std::size_t e{ 0 }; e < n; ++e)
+        {
+            int& value{ data[a * n + e] };
+            switch (pattern)
+            {
+            case Pattern::random:    value = static_cast<int>(mt()); break;
+            case Pattern::sorted:    value = static_cast<int>(e); break;
+            case Pattern::reversed:  value = static_cast<int>(n - e); break;
+            case Pattern::allEqual:  value = 7; break;
+            case Pattern::organPipe: value = static_cast<int>(std::min(e, n - 1 - e)); break;
+            }
+        }
+    }
+    return data;
+}
+
+// Reorders "array after array" into the 8-lane interleaved layout (and back)
+void interleave(const std::vector<int>& in, std::vector<int>& out, std::size_t n)
+{
+    for (std::size_t block{ 0 }; block < in.size() / (n * lanes); ++block)
+        for (std::size_t a{ 0 }; a < lanes; ++a)
+            for (std::size_t e{ 0 }; e < n; ++e)
+                out[block * n * lanes + e * lanes + a] = in[(block * lanes + a) * n + e];
+}
+
+template <typename Fn>
+double nsPerArray(std::size_t numArrays, Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    fn();
+    const std::chrono::duration<double, std::nano> elapsed{ std::chrono::steady_clock::now() - start };
+    return elapsed.count() / static_cast<double>(numArrays);
+}
+
+template <std::size_t N>
+void benchmark(Pattern pattern)
+{
+    constexpr std::size_t numArrays{ 1 << 16 }; // multiple of lanes
+    const std::vector<int> input{ makeInput(pattern, N, numArrays) };
+
+    std::vector<int> viaStd{ input };
+    const double stdNs{ nsPerArray(numArrays, [&] {
+        for (std::size_t a{ 0 }; a < numArrays; ++a)
+            std::sort(viaStd.begin() + a * N, viaStd.begin() + (a + 1) * N);
+    }) };
+
+    std::vector<int> viaNetwork{ input };
+    const double networkNs{ nsPerArray(numArrays, [&] {
+        for (std::size_t a{ 0 }; a < numArrays; ++a)
+            networkSort<N>(viaNetwork.data() + a * N);
+    }) };
+
+    std::vector<int> interleaved(input.size());
+    interleave(input, interleaved, N);
+    const double lanesNs{ nsPerArray(numArrays, [&] {
+        for (std::size_t block{ 0 }; block < numArrays / lanes; ++block)
+            networkSortLanes<N>(interleaved.data() + block * N * lanes);
+    }) };
+
+    // Check the lane version by sorting the input with std::sort and interleaving that
+    std::vector<int> expected(input.size());
+    interleave(viaStd, expected, N);
+
+    const bool ok{ viaNetwork == viaStd && interleaved == expected };
+    std::cout << "N=" << N << '\t' << patternName(pattern) << "\tstd::sort " << stdNs << " ns\tnetwork " << networkNs
+              << " ns\t8-lane " << lanesNs << " ns" << (ok ? "" : "\tMISMATCH!") << '\n';
+}
+
+template <std::size_t... N>
+void benchmarkSizes(Pattern pattern)
+{
+    (benchmark<N>(pattern), ...);
+}
+
+int main()
+{
+    int x{ 7 };
+    int y{ 5 };
+    sort2(x, y);
+    std::cout << x << ' ' << y << '\n'; // 5 7
+
+    // Same result without the branch
+    std::array pair{ 7, 5 };
+    networkSort<2>(pair.data());
+    std::cout << pair[0] << ' ' << pair[1] << '\n'; // 5 7
+
+    std::array<float, 5> floats{ 2.5f, -1.0f, 9.0f, 0.0f, 3.25f };
+    networkSort<5>(floats.data());
+    for (float f : floats)
+        std::cout << f << ' ';
+    std::cout << '\n';
+
+    std::array<KeyValue<int, char>, 4> people{ { { 30, 'c' }, { 10, 'a' }, { 40, 'd' }, { 20, 'b' } } };
+    networkSort<4>(people.data());
+    for (const auto& kv : people)
+        std::cout << kv.key << ':' << kv.value << ' ';
+    std::cout << '\n';
+
+    std::cout << "comparators for N = 4, 8, 16, 32: " << sortingNetwork<4>.size() << ", " << sortingNetwork<8>.size()
+              << ", " << sortingNetwork<16>.size() << ", " << sortingNetwork<32>.size() << "\n\n";
+
+    for (Pattern pattern : { Pattern::random, Pattern::sorted, Pattern::reversed, Pattern::allEqual, Pattern::organPipe })
+        benchmarkSizes<2, 4, 8, 16, 32>(pattern);
+
+    return 0;
+}
@@ -0,0 +1,594 @@
+// structs_q1.cpp's Stats holds one hand-typed record: how many ads were watched, what percentage
+// got clicked, and the average earning per click. In production the same numbers have to come out
+// of an endless stream of ad events, per ad, and keep answering questions like:
+//   - what did this ad earn in the last 5 minutes?        -> WindowedTotals
+//   - how many different users saw it?                    -> HyperLogLog
+//   - what's the median (p50) and p99 earning per click?   -> KllSketch
+//
+// Keeping every event to answer those exactly needs memory that grows forever. Each of these
+// "sketches" uses a fixed, small amount of memory instead, and gives an answer that's exact
+// (the window totals) or close, with a known error (the other two).
+//
+// Every sketch can also be merged with another of the same kind, and the result is the same as if
+// one sketch had seen both streams. So each thread can fill its own sketches without any locking,
+// and they're combined at the end (or whenever a report is wanted).
+//
+// Build with -O2 -pthread.
+
+#include <algorithm> // for std::max, std::sort, std::nth_element
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip> // for std::setw, std::setprecision
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility> // for std::pair
+#include <vector>
+
+// From structs_q1.cpp
+struct Stats
+{
+    int ads{};
+    int clickedAds{}; // percentage
+    double earningPerAd{};
+};
+
+double getEarnings(const Stats& stats)
+{
+    return stats.ads * (stats.clickedAds / 100.0) * stats.earningPerAd;
+}
+
+// One user seeing one ad, and maybe clicking it
+struct AdEvent
+{
+    std::uint64_t timeMs{};
+    std::uint64_t userId{};
+    std::uint32_t adId{};
+    bool clicked{};
+    double earning{}; // 0 unless clicked
+};
+
+// Spreads similar ids (1, 2, 3, ...) over all 64 bits (the splitmix64 finalizer)
+std::uint64_t mix64(std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// ----------------------------------------------------------------------------------------------
+// Sliding window totals
+
+struct Totals
+{
+    std::uint64_t views{};
+    std::uint64_t clicks{};
+    double earnings{};
+
+    // Back to structs_q1.cpp's Stats (clickedAds is a whole percentage there, so this rounds)
+    Stats toStats() const
+    {
+        const int percent{ views == 0 ? 0 : static_cast<int>(std::lround(100.0 * static_cast<double>(clicks) / static_cast<double>(views))) };
+        return { static_cast<int>(views), percent, clicks == 0 ? 0.0 : earnings / static_cast<double>(clicks) };
+    }
+};
+
+// The window is cut into buckets (say 60 buckets of 5 seconds for a 5 minute window), kept in a
+// ring. An event adds to the bucket for its time; a bucket that comes round again is cleared first.
+// A query adds up the buckets still inside the window. Memory is one Totals per bucket, however
+// many events there are, and the answer is exact for windows that start on a bucket boundary.
+class WindowedTotals
+{
+public:
+    WindowedTotals(std::uint64_t bucketMs, std::size_t buckets)
+        : m_bucketMs{ bucketMs }, m_buckets(buckets)
+    {
+        assert(bucketMs != 0 && "bucketMs must be at least 1");
+        assert(buckets != 0 && "need at least one bucket");
+    }
+
+    void add(std::uint64_t timeMs, bool clicked, double earning)
+    {
+        const std::uint64_t index{ timeMs / m_bucketMs };
+        Bucket& bucket{ m_buckets[index % m_buckets.size()] };
+        if (bucket.index != index)
+        {
+            if (bucket.index != empty && bucket.index > index)
+                return; // too old: that slot has already moved on to a newer bucket
+            bucket = { index, {} };
+        }
+        ++bucket.totals.views;
+        bucket.totals.clicks += clicked;
+        bucket.totals.earnings += earning;
+    }
+
+    // Totals over the buckets that end the window at nowMs
+    Totals query(std::uint64_t nowMs) const
+    {
+        const std::uint64_t newest{ nowMs / m_bucketMs };
+        const std::uint64_t oldest{ newest + 1 >= m_buckets.size() ? newest + 1 - m_buckets.size() : 0 };
+        Totals sum{};
+        for (const Bucket& bucket : m_buckets)
+        {
+            if (bucket.index != empty && bucket.index >= oldest && bucket.index <= newest)
+            {
+                sum.views += bucket.totals.views;
+                sum.clicks += bucket.totals.clicks;
+                sum.earnings += bucket.totals.earnings;
+            }
+        }
+        return sum;
+    }
+
+    // Same bucket in both: add. Different buckets in the same slot: the newer one wins.
+    void merge(const WindowedTotals& other)
+    {
+        for (std::size_t i{ 0 }; i < m_buckets.size(); ++i)
+        {
+            Bucket& mine{ m_buckets[i] };
+            const Bucket& theirs{ other.m_buckets[i] };
+            if (theirs.index == empty)
+                continue;
+            if (mine.index == empty || theirs.index > mine.index)
+            {
+                mine = theirs;
+            }
+            else if (theirs.index == mine.index)
+            {
+                mine.totals.views += theirs.totals.views;
+                mine.totals.clicks += theirs.totals.clicks;
+                mine.totals.earnings += theirs.totals.earnings;
+            }
+        }
+    }
+
+    std::uint64_t windowMs() const { return m_bucketMs * m_buckets.size(); }
+    std::size_t memoryBytes() const { return m_buckets.size() * sizeof(Bucket); }
+
+private:
+    static constexpr std::uint64_t empty{ std::numeric_limits<std::uint64_t>::max() };
+
+    struct Bucket
+    {
+        std::uint64_t index{ empty }; // time / bucketMs of the events in it
+        Totals totals{};
+    };
+
+    std::uint64_t m_bucketMs{};
+    std::vector<Bucket> m_buckets{};
+};
+
+// ----------------------------------------------------------------------------------------------
+// Distinct count
+
+// Hash every user id. In random bits, a run of r leading zeros turns up about once per 2^r
+// different values, so the longest run seen says roughly how many different values there were.
+// One run is a noisy guess, so the hashes are split into 2^Precision groups by their first bits,
+// each group remembers its longest run in one byte, and the estimate averages all the groups.
+// Standard error is about 1.04 / sqrt(2^Precision): 1.6% for Precision 12, in 4 KiB.
+// Seeing the same user again changes nothing, and merging is a max per group.
+template <int Precision>
+class HyperLogLog
+{
+public:
+    static constexpr std::size_t registerCount{ std::size_t{ 1 } << Precision };
+
+    void add(std::uint64_t hash)
+    {
+        const std::size_t group{ static_cast<std::size_t>(hash >> (64 - Precision)) };
+        // The bits after the group number, with a 1 planted at the end so they can't be all zeros
+        const std::uint64_t rest{ (hash << Precision) | (std::uint64_t{ 1 } << (Precision - 1)) };
+        const std::uint8_t run{ static_cast<std::uint8_t>(__builtin_clzll(rest) + 1) };
+        m_registers[group] = std::max(m_registers[group], run);
+    }
+
+    double estimate() const
+    {
+        double sum{ 0.0 };
+        std::size_t zeros{ 0 };
+        for (std::uint8_t r : m_registers)
+        {
+            sum += std::ldexp(1.0, -r);
+            zeros += (r == 0);
+        }
+        const double m{ static_cast<double>(registerCount) };
+        const double alpha{ 0.7213 / (1.0 + 1.079 / m) };
+        const double raw{ alpha * m * m / sum };
+        // With few values many groups are still empty, and counting those is more accurate
+        if (raw <= 2.5 * m && zeros != 0)
+            return m * std::log(m / static_cast<double>(zeros));
+        return raw;
+    }
+
+    void merge(const HyperLogLog& other)
+    {
+        for (std::size_t i{ 0 }; i < registerCount; ++i)
+            m_registers[i] = std::max(m_registers[i], other.m_registers[i]);
+    }
+
+    std::size_t memoryBytes() const { return sizeof(m_registers); }
+
+private:
+    std::array<std::uint8_t, registerCount> m_registers{};
+};
+
+// ----------------------------------------------------------------------------------------------
+// Quantiles
+
+// KLL sketch. Values go into level 0. When a level gets full it's sorted and "compacted": every
+// other value (starting at a random one of the first two) moves up a level, and the rest are
+// dropped. A value on level h stands for 2^h of the original values, so the total weight is kept,
+// and the random start means the rank errors cancel out on average instead of piling up.
+// Lower levels get less room than higher ones (each 2/3 of the one above), so memory stays at
+// O(k log(n / k)) values. Rank error is about 1.7 / k: under 1% for k = 200.
+class KllSketch
+{
+public:
+    explicit KllSketch(int k = 200, std::uint64_t seed = 1)
+        : m_k{ k }, m_random{ seed | 1 }, m_levels(1)
+    {
+    }
+
+    void add(double value)
+    {
+        m_levels[0].push_back(value);
+        ++m_count;
+        if (++m_size > capacityTotal())
+            compress();
+    }
+
+    void merge(const KllSketch& other)
+    {
+        if (other.m_levels.size() > m_levels.size())
+            m_levels.resize(other.m_levels.size());
+        for (std::size_t h{ 0 }; h < other.m_levels.size(); ++h)
+            m_levels[h].insert(m_levels[h].end(), other.m_levels[h].begin(), other.m_levels[h].end());
+        m_count += other.m_count;
+        m_size += other.m_size;
+        compress();
+    }
+
+    std::uint64_t count() const { return m_count; }
+
+    // The value with a fraction q of all values below it (q = 0.5 is the median)
+    double quantile(double q) const
+    {
+        std::vector<std::pair<double, std::uint64_t>> weighted{};
+        weighted.reserve(m_size);
+        for (std::size_t h{ 0 }; h < m_levels.size(); ++h)
+        {
+            for (double v : m_levels[h])
+                weighted.emplace_back(v, std::uint64_t{ 1 } << h);
+        }
+        if (weighted.empty())
+            return 0.0;
+        std::sort(weighted.begin(), weighted.end());
+
+        std::uint64_t total{ 0 };
+        for (const auto& [value, weight] : weighted)
+            total += weight;
+        const double target{ q * static_cast<double>(total) };
+        std::uint64_t seen{ 0 };
+        for (const auto& [value, weight] : weighted)
+        {
+            seen += weight;
+            if (static_cast<double>(seen) > target)
+                return value;
+        }
+        return weighted.back().first;
+    }
+
+    std::size_t memoryBytes() const { return m_size * sizeof(double) + m_levels.size() * sizeof(std::vector<double>); }
+
+private:
+    std::size_t capacity(std::size_t level) const
+    {
+        const std::size_t depth{ m_levels.size() - 1 - level };
+        return std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(m_k * std::pow(2.0 / 3.0, static_cast<double>(depth)))));
+    }
+
+    std::size_t capacityTotal() const
+    {
+        std::size_t total{ 0 };
+        for (std::size_t h{ 0 }; h < m_levels.size(); ++h)
+            total += capacity(h);
+        return total;
+    }
+
+    bool coinFlip()
+    {
+        m_random ^= m_random << 13; // xorshift64
+        m_random ^= m_random >> 7;
+        m_random ^= m_random << 17;
+        return m_random & 1;
+    }
+
+    // Compacts the lowest full level, until everything fits
+    void compress()
+    {
+        while (m_size > capacityTotal())
+        {
+            for (std::size_t h{ 0 }; h < m_levels.size(); ++h)
+            {
+                if (m_levels[h].size() < capacity(h))
+                    continue;
+                if (h + 1 == m_levels.size())
+                    m_levels.emplace_back(); // (this also raises every level's capacity)
+
+                std::vector<double>& level{ m_levels[h] };
+                std::sort(level.begin(), level.end());
+                // An odd one out stays behind, so the weight moved up is exactly halved
+                const std::size_t pairs{ level.size() / 2 };
+                const double leftover{ level.back() };
+                const bool odd{ level.size() % 2 == 1 };
+                const std::size_t offset{ coinFlip() ? 1u : 0u };
+                std::vector<double>& up{ m_levels[h + 1] };
+                for (std::size_t i{ 0 }; i < pairs; ++i)
+                    up.push_back(level[2 * i + offset]);
+                level.clear();
+                if (odd)
+                    level.push_back(leftover);
+                m_size -= pairs;
+                break;
+            }
+        }
+    }
+
+    int m_k{};
+    std::uint64_t m_random{};
+    std::vector<std::vector<double>> m_levels{};
+    std::size_t m_size{ 0 };   // values kept, over all levels
+    std::uint64_t m_count{ 0 }; // values added
+};
+
+// ----------------------------------------------------------------------------------------------
+// Everything per ad
+
+struct AdReport
+{
+    Totals window{};
+    double distinctViewers{};
+    double p50{};
+    double p99{};
+};
+
+class AdStream
+{
+public:
+    AdStream(std::uint64_t bucketMs, std::size_t buckets)
+        : m_bucketMs{ bucketMs }, m_buckets{ buckets }
+    {
+    }
+
+    void add(const AdEvent& e)
+    {
+        AdSketches& ad{ sketchesFor(e.adId) };
+        ad.window.add(e.timeMs, e.clicked, e.earning);
+        ad.viewers.add(mix64(e.userId));
+        if (e.clicked)
+            ad.earnings.add(e.earning);
+    }
+
+    void merge(const AdStream& other)
+    {
+        for (const auto& [adId, theirs] : other.m_ads)
+        {
+            AdSketches& mine{ sketchesFor(adId) };
+            mine.window.merge(theirs.window);
+            mine.viewers.merge(theirs.viewers);
+            mine.earnings.merge(theirs.earnings);
+        }
+    }
+
+    AdReport report(std::uint32_t adId, std::uint64_t nowMs) const
+    {
+        const auto found{ m_ads.find(adId) };
+        if (found == m_ads.end())
+            return {};
+        const AdSketches& ad{ found->second };
+        return { ad.window.query(nowMs), ad.viewers.estimate(), ad.earnings.quantile(0.5), ad.earnings.quantile(0.99) };
+    }
+
+    std::size_t ads() const { return m_ads.size(); }
+
+    std::size_t memoryBytes() const
+    {
+        std::size_t total{ 0 };
+        for (const auto& [adId, ad] : m_ads)
+            total += ad.window.memoryBytes() + ad.viewers.memoryBytes() + ad.earnings.memoryBytes();
+        return total;
+    }
+
+private:
+    struct AdSketches
+    {
+        WindowedTotals window;
+        HyperLogLog<12> viewers{};
+        KllSketch earnings{};
+    };
+
+    AdSketches& sketchesFor(std::uint32_t adId)
+    {
+        auto found{ m_ads.find(adId) };
+        if (found == m_ads.end())
+            found = m_ads.emplace(adId, AdSketches{ WindowedTotals{ m_bucketMs, m_buckets }, {}, KllSketch{ 200, adId + 1 } }).first;
+        return found->second;
+    }
+
+    std::uint64_t m_bucketMs{};
+    std::size_t m_buckets{};
+    std::unordered_map<std::uint32_t, AdSketches> m_ads{};
+};
+
+// ----------------------------------------------------------------------------------------------
+
+// An hour of traffic: a few ads get most of the views, some users watch a lot, ~8% of views are clicked
+std::vector<AdEvent> makeEvents(std::size_t count, std::uint32_t adCount)
+{
+    std::mt19937_64 mt{ 49 };
+    std::vector<double> adWeights(adCount);
+    for (std::uint32_t i{ 0 }; i < adCount; ++i)
+        adWeights[i] = 1.0 / (i + 1.0);
+    std::discrete_distribution<std::uint32_t> ads{ adWeights.begin(), adWeights.end() };
+    std::geometric_distribution<std::uint64_t> users{ 1.0 / 400'000.0 };
+    std::lognormal_distribution<double> earning{ -1.0, 0.8 };
+    std::bernoulli_distribution click{ 0.08 };
+
+    std::vector<AdEvent> events(count);
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        AdEvent& e{ events[i] };
+        e.timeMs = i * 3'600'000 / count;
+        e.adId = ads(mt);
+        e.userId = users(mt);
+        e.clicked = click(mt);
+        e.earning = e.clicked ? std::round(earning(mt) * 10000.0) / 10000.0 : 0.0;
+    }
+    return events;
+}
+
+template <typename Fn>
+double seconds(Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    fn();
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    return elapsed.count();
+}
+
+// Where value falls among the sorted values, as a fraction (how far off a quantile estimate is)
+double rankOf(const std::vector<double>& sorted, double value)
+{
+    return static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin()) / static_cast<double>(sorted.size());
+}
+
+int main()
+{
+    constexpr std::size_t eventCount{ 10'000'000 };
+    constexpr std::uint32_t adCount{ 200 };
+    constexpr std::uint64_t bucketMs{ 5'000 };
+    constexpr std::size_t buckets{ 60 }; // a 5 minute window
+
+    std::cout << "Generating " << eventCount << " events for " << adCount << " ads...\n";
+    const std::vector<AdEvent> events{ makeEvents(eventCount, adCount) };
+    const std::uint64_t now{ events.back().timeMs };
+
+    // One thread
+    AdStream single{ bucketMs, buckets };
+    const double singleTime{ seconds([&] {
+        for (const AdEvent& e : events)
+            single.add(e);
+    }) };
+
+    // One stream per thread, each taking a slice of the events, then merged
+    const std::size_t threadCount{ std::max(2u, std::thread::hardware_concurrency()) };
+    std::vector<AdStream> perThread(threadCount, AdStream{ bucketMs, buckets });
+    const double parallelTime{ seconds([&] {
+        std::vector<std::thread> threads{};
+        for (std::size_t t{ 0 }; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t] {
+                const std::size_t begin{ events.size() * t / threadCount };
+                const std::size_t end{ events.size() * (t + 1) / threadCount };
+                for (std::size_t i{ begin }; i < end; ++i)
+                    perThread[t].add(events[i]);
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+    }) };
+    AdStream merged{ bucketMs, buckets };
+    const double mergeTime{ seconds([&] {
+        for (const AdStream& stream : perThread)
+            merged.merge(stream);
+    }) };
+
+    std::cout << "one thread:  " << eventCount / singleTime / 1e6 << " M events/sec\n";
+    std::cout << threadCount << " threads: " << eventCount / parallelTime / 1e6 << " M events/sec, then "
+              << mergeTime * 1000 << " ms to merge their sketches\n";
+    std::cout << "sketch memory: " << single.memoryBytes() / 1024 << " KiB for " << single.ads() << " ads (the events are "
+              << events.size() * sizeof(AdEvent) / (1024 * 1024) << " MiB)\n";
+
+    // Compare with the exact answers for the busiest ads
+    std::cout << "\n ad | window views  exact | distinct viewers  exact   error | p50  (rank) | p99  (rank)\n";
+    const std::uint64_t windowStart{ (now / bucketMs + 1 - buckets) * bucketMs };
+    double worstDistinct{ 0.0 };
+    double worstRank{ 0.0 };
+    bool windowsExact{ true };
+    for (std::uint32_t adId{ 0 }; adId < adCount; ++adId)
+    {
+        Totals exactWindow{};
+        std::unordered_set<std::uint64_t> viewers{};
+        std::vector<double> earnings{};
+        for (const AdEvent& e : events)
+        {
+            if (e.adId != adId)
+                continue;
+            viewers.insert(e.userId);
+            if (e.clicked)
+                earnings.push_back(e.earning);
+            if (e.timeMs >= windowStart)
+            {
+                ++exactWindow.views;
+                exactWindow.clicks += e.clicked;
+                exactWindow.earnings += e.earning;
+            }
+        }
+        std::sort(earnings.begin(), earnings.end());
+
+        for (const AdStream* stream : { &single, &merged })
+        {
+            const AdReport r{ stream->report(adId, now) };
+            windowsExact = windowsExact && r.window.views == exactWindow.views && r.window.clicks == exactWindow.clicks
+                           && std::abs(r.window.earnings - exactWindow.earnings) < 1e-6 * (1.0 + exactWindow.earnings);
+            worstDistinct = std::max(worstDistinct, std::abs(r.distinctViewers / static_cast<double>(viewers.size()) - 1.0));
+            if (earnings.size() >= 1000) // p99 of a handful of clicks isn't meaningful either way
+                worstRank = std::max({ worstRank, std::abs(rankOf(earnings, r.p50) - 0.5), std::abs(rankOf(earnings, r.p99) - 0.99) });
+        }
+
+        if (adId < 5)
+        {
+            const AdReport r{ merged.report(adId, now) };
+            std::cout << std::setw(3) << adId << " | " << std::setw(12) << r.window.views << std::setw(7) << exactWindow.views << " | "
+                      << std::setw(16) << std::lround(r.distinctViewers) << std::setw(7) << viewers.size() << std::setw(7)
+                      << std::fixed << std::setprecision(2) << 100.0 * (r.distinctViewers / static_cast<double>(viewers.size()) - 1.0) << "% | "
+                      << std::setprecision(3) << r.p50 << " (" << rankOf(earnings, r.p50) << ") | " << r.p99 << " (" << rankOf(earnings, r.p99) << ")\n"
+                      << std::defaultfloat << std::setprecision(6);
+        }
+    }
+    std::cout << "\nwindow totals exact for every ad, single and merged: " << (windowsExact ? "yes" : "NO") << '\n';
+    std::cout << "worst distinct-viewer error: " << 100.0 * worstDistinct << "% (standard error is 1.6%; worst of 200 independent estimates, merging gives the same HLL)\n";
+    std::cout << "worst quantile rank error:   " << 100.0 * worstRank << "% (ads with 1000+ clicks)\n";
+
+    // And back to structs_q1.cpp's Stats, for the busiest ad's last 5 minutes
+    const Stats stats{ merged.report(0, now).window.toStats() };
+    std::cout << "\nad 0, last 5 minutes as a Stats: " << stats.ads << " ads, " << stats.clickedAds << "% clicked, $"
+              << stats.earningPerAd << " per click -> getEarnings() = $" << getEarnings(stats) << '\n';
+    return 0;
+}
+
+/* Sample results (one slow core, so the two threads share it):
+one thread:  25.3 M events/sec
+2 threads: 25.8 M events/sec, then 9 ms to merge their sketches
+sketch memory: 1835 KiB for 200 ads (the events are 305 MiB)
+
+ ad | window views  exact | distinct viewers  exact   error | p50  (rank) | p99  (rank)
+  0 |       141925 141925 |           802854 810969  -1.00% | 0.370 (0.501) | 2.372 (0.990)
+  1 |        70976  70976 |           546343 549539  -0.58% | 0.368 (0.499) | 2.161 (0.987)
+  2 |        47339  47339 |           418370 417241   0.27% | 0.367 (0.500) | 2.267 (0.987)
+
+window totals exact for every ad, single and merged: yes
+worst distinct-viewer error: 5.2% (standard error is 1.6%; worst of 200 independent estimates, merging gives the same HLL)
+worst quantile rank error:   0.86% (ads with 1000+ clicks)
+
+ad 0, last 5 minutes as a Stats: 141925 ads, 8% clicked, $0.5016 per click -> getEarnings() = $5694.89
+*/
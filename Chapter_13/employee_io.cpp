@@ -0,0 +1,674 @@
+// structs.cpp prints an Employee with operator<<, and that's the only way one ever leaves the
+// program; nothing reads it back in. This file saves and loads whole batches of Employees as
+// CSV ("id,age,wage" per line) or JSON lines ({"id":1,"age":30,"wage":50000} per line).
+//
+// Writing: every number is formatted with std::to_chars straight into a big buffer, which is
+// handed to the stream once per MiB instead of once per value. to_chars writes the shortest text
+// that reads back as exactly the same double, so save + load gives back identical wages.
+//
+// Reading: the text is scanned 64 bytes at a time, the same way Chapter_4/simd_tokenizer.cpp does:
+// one SIMD compare per character gives a 64-bit mask of where the ',' and '\n' bytes are, and the
+// fields are cut out of the text from those masks. Each field is converted with std::from_chars.
+// A bad row doesn't stop the load: it's skipped and reported with its line number and the reason.
+//
+// The scan kernel exists in scalar, SSE4.2, AVX2 and AVX-512 versions; cpu_features.h picks the
+// best one at startup (LEARNCPP_SIMD=scalar forces the slow one for testing).
+//
+// Build with -O2.
+
+#include <charconv> // for std::to_chars, std::from_chars
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy, std::memset
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error> // for std::errc
+#include <vector>
+#include <immintrin.h>
+#include "../Chapter_4/cpu_features.h"
+
+struct Employee
+{
+    int id{};
+    int age{};
+    double wage{ 50000.0 };
+};
+
+bool operator==(const Employee& a, const Employee& b)
+{
+    return a.id == b.id && a.age == b.age && a.wage == b.wage;
+}
+
+// The old way out (from structs.cpp), for the benchmark
+std::ostream& operator<<(std::ostream& out, const Employee& e)
+{
+    out << "ID: " << e.id << ", Age: " << e.age << ", Wage: " << e.wage;
+    return out;
+}
+
+// ----------------------------------------------------------------------------------------------
+// Writing
+
+// Longest row either format can produce: two ints of up to 11 chars, a double of up to 24,
+// and the punctuation and key names around them
+constexpr std::size_t maxRowLength{ 96 };
+constexpr std::size_t writeBufferSize{ 1 << 20 };
+
+constexpr std::string_view csvHeader{ "id,age,wage" };
+
+// Collects text in a big buffer and hands it to the stream only when it's nearly full
+class RowWriter
+{
+public:
+    explicit RowWriter(std::ostream& out)
+        : m_out{ out }, m_buffer(writeBufferSize)
+    {
+    }
+
+    ~RowWriter() { flush(); }
+
+    RowWriter(const RowWriter&) = delete;
+    RowWriter& operator=(const RowWriter&) = delete;
+
+    // Call before writing a row: makes sure maxRowLength chars fit
+    char* reserveRow()
+    {
+        if (m_buffer.size() - m_used < maxRowLength)
+            flush();
+        return m_buffer.data() + m_used;
+    }
+
+    void commit(char* end) { m_used = static_cast<std::size_t>(end - m_buffer.data()); }
+
+    void flush()
+    {
+        m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+        m_used = 0;
+    }
+
+private:
+    std::ostream& m_out;
+    std::vector<char> m_buffer{};
+    std::size_t m_used{ 0 };
+};
+
+// Each of these appends one value at p and returns where it ended.
+// The buffer always has room (see maxRowLength), so to_chars can't fail here.
+char* putInt(char* p, int value)
+{
+    return std::to_chars(p, p + 11, value).ptr;
+}
+
+char* putDouble(char* p, double value)
+{
+    return std::to_chars(p, p + 24, value).ptr;
+}
+
+char* putText(char* p, std::string_view text)
+{
+    std::memcpy(p, text.data(), text.size());
+    return p + text.size();
+}
+
+void writeCsv(std::ostream& out, const Employee* employees, std::size_t count)
+{
+    RowWriter writer{ out };
+    char* p{ writer.reserveRow() };
+    p = putText(p, csvHeader);
+    *p++ = '\n';
+    writer.commit(p);
+
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        p = writer.reserveRow();
+        p = putInt(p, employees[i].id);
+        *p++ = ',';
+        p = putInt(p, employees[i].age);
+        *p++ = ',';
+        p = putDouble(p, employees[i].wage);
+        *p++ = '\n';
+        writer.commit(p);
+    }
+}
+
+// Wages must be finite: JSON has no way to write inf or nan
+void writeJsonLines(std::ostream& out, const Employee* employees, std::size_t count)
+{
+    RowWriter writer{ out };
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        char* p{ writer.reserveRow() };
+        p = putText(p, "{\"id\":");
+        p = putInt(p, employees[i].id);
+        p = putText(p, ",\"age\":");
+        p = putInt(p, employees[i].age);
+        p = putText(p, ",\"wage\":");
+        p = putDouble(p, employees[i].wage);
+        p = putText(p, "}\n");
+        writer.commit(p);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------
+// Scanning
+
+// Result of looking at one 64-byte block
+struct BlockMasks
+{
+    std::uint64_t commas{};   // bit i set if byte i is ','
+    std::uint64_t newlines{}; // bit i set if byte i is '\n'
+};
+
+using ScanFn = BlockMasks (*)(const char* block);
+
+BlockMasks scanScalar(const char* block)
+{
+    BlockMasks masks{};
+    for (std::size_t i{ 0 }; i < 64; ++i)
+    {
+        masks.commas |= std::uint64_t{ block[i] == ',' } << i;
+        masks.newlines |= std::uint64_t{ block[i] == '\n' } << i;
+    }
+    return masks;
+}
+
+CPU_TARGET_SSE42 BlockMasks scanSse42(const char* block)
+{
+    const __m128i comma{ _mm_set1_epi8(',') };
+    const __m128i newline{ _mm_set1_epi8('\n') };
+
+    BlockMasks masks{};
+    for (int part{ 0 }; part < 4; ++part)
+    {
+        const __m128i x{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + part * 16)) };
+        masks.commas |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, comma)))) << (part * 16);
+        masks.newlines |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, newline)))) << (part * 16);
+    }
+    return masks;
+}
+
+CPU_TARGET_AVX2 BlockMasks scanAvx2(const char* block)
+{
+    const __m256i comma{ _mm256_set1_epi8(',') };
+    const __m256i newline{ _mm256_set1_epi8('\n') };
+
+    BlockMasks masks{};
+    for (int part{ 0 }; part < 2; ++part)
+    {
+        const __m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + part * 32)) };
+        masks.commas |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, comma)))) << (part * 32);
+        masks.newlines |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, newline)))) << (part * 32);
+    }
+    return masks;
+}
+
+CPU_TARGET_AVX512 BlockMasks scanAvx512(const char* block)
+{
+    const __m512i x{ _mm512_loadu_si512(block) };
+    return { _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(',')), _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('\n')) };
+}
+
+constexpr CpuFeatures::Implementations<ScanFn> scanImpls{ scanScalar, scanSse42, scanAvx2, scanAvx512 };
+
+ScanFn bestScanner()
+{
+    static const ScanFn best{ CpuFeatures::select(scanImpls) };
+    return best;
+}
+
+// Calls onBlock(blockStart, masks) for each 64-byte block of text, in order
+template <typename OnBlock>
+void forEachBlock(std::string_view text, ScanFn scan, OnBlock onBlock)
+{
+    std::size_t blockStart{ 0 };
+    for (; blockStart + 64 <= text.size(); blockStart += 64)
+        onBlock(blockStart, scan(text.data() + blockStart));
+
+    if (blockStart < text.size())
+    {
+        // Last partial block: copy it out and pad with spaces (not a separator) so we never read past the buffer
+        char padded[64];
+        std::memset(padded, ' ', sizeof(padded));
+        std::memcpy(padded, text.data() + blockStart, text.size() - blockStart);
+        onBlock(blockStart, scan(padded));
+    }
+}
+
+// ----------------------------------------------------------------------------------------------
+// Reading
+
+struct RowError
+{
+    std::size_t line{}; // 1-based
+    std::string reason{};
+};
+
+struct LoadResult
+{
+    std::vector<Employee> employees{};
+    std::vector<RowError> errors{};
+};
+
+// The whole field must be the number: "12x" and "" are errors, not 12 and 0
+template <typename T>
+bool parseField(std::string_view field, T& value)
+{
+    const char* end{ field.data() + field.size() };
+    const auto [ptr, ec]{ std::from_chars(field.data(), end, value) };
+    return ec == std::errc{} && ptr == end;
+}
+
+// Also accepts files written on Windows
+std::string_view stripCarriageReturn(std::string_view line)
+{
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    return line;
+}
+
+class CsvLoader
+{
+public:
+    CsvLoader(LoadResult& result, std::size_t firstLine)
+        : m_result{ result }, m_line{ firstLine }
+    {
+    }
+
+    // A ',' or '\n' at position pos of text
+    void separator(std::string_view text, std::size_t pos, bool newline)
+    {
+        const std::string_view field{ text.substr(m_fieldStart, pos - m_fieldStart) };
+        m_fieldStart = pos + 1;
+
+        if (newline)
+            endRow(stripCarriageReturn(field));
+        else
+            addField(field);
+    }
+
+    // The text doesn't have to end in '\n'
+    void finish(std::string_view text)
+    {
+        if (m_fieldStart < text.size() || m_fieldCount > 0)
+            endRow(stripCarriageReturn(text.substr(m_fieldStart)));
+    }
+
+private:
+    void addField(std::string_view field)
+    {
+        if (m_fieldCount == 0 && !parseField(field, m_row.id))
+            fail("id is not a whole number");
+        else if (m_fieldCount == 1 && !parseField(field, m_row.age))
+            fail("age is not a whole number");
+        ++m_fieldCount;
+    }
+
+    void endRow(std::string_view lastField)
+    {
+        if (m_fieldCount == 2)
+        {
+            if (!parseField(lastField, m_row.wage))
+                fail("wage is not a number");
+        }
+        else if (m_fieldCount != 0 || !lastField.empty()) // blank lines are fine
+        {
+            fail("expected 3 fields, got " + std::to_string(m_fieldCount + 1));
+        }
+
+        if (!m_failed && m_fieldCount == 2)
+            m_result.employees.push_back(m_row);
+
+        ++m_line;
+        m_fieldCount = 0;
+        m_failed = false;
+    }
+
+    void fail(std::string reason)
+    {
+        if (!m_failed) // one error per row is enough
+            m_result.errors.push_back({ m_line, std::move(reason) });
+        m_failed = true;
+    }
+
+    LoadResult& m_result;
+    Employee m_row{};
+    std::size_t m_fieldStart{ 0 };
+    int m_fieldCount{ 0 };
+    bool m_failed{ false };
+    std::size_t m_line{};
+};
+
+LoadResult loadCsv(std::string_view text, ScanFn scan = bestScanner())
+{
+    LoadResult result{};
+    std::size_t firstLine{ 1 };
+    for (std::string_view header : { "id,age,wage\n", "id,age,wage\r\n" })
+    {
+        if (text.substr(0, header.size()) == header)
+        {
+            text.remove_prefix(header.size());
+            firstLine = 2;
+        }
+    }
+
+    CsvLoader loader{ result, firstLine };
+
+    forEachBlock(text, scan, [&](std::size_t blockStart, BlockMasks masks) {
+        std::uint64_t separators{ masks.commas | masks.newlines };
+
+        // Visit the separators lowest bit first, i.e. in text order
+        while (separators != 0)
+        {
+            const std::uint64_t bit{ separators & (~separators + 1) };
+            separators ^= bit;
+            const std::size_t pos{ blockStart + static_cast<std::size_t>(__builtin_ctzll(bit)) };
+            loader.separator(text, pos, (masks.newlines & bit) != 0);
+        }
+    });
+    loader.finish(text);
+    return result;
+}
+
+// ----------------------------------------------------------------------------------------------
+// JSON lines
+
+// A tiny parser for one flat object of numbers, like {"id":1, "age":30, "wage":50000.5}.
+// Keys may come in any order with whitespace anywhere between tokens; strings with escapes,
+// nested objects and unknown keys are rejected. Returns nullptr on success, otherwise the reason.
+class JsonLineParser
+{
+public:
+    explicit JsonLineParser(std::string_view line)
+        : m_line{ line }
+    {
+    }
+
+    const char* parse(Employee& e)
+    {
+        if (!consume('{'))
+            return "expected '{'";
+
+        unsigned seen{ 0 }; // bit 0: id, bit 1: age, bit 2: wage
+        for (;;)
+        {
+            skipSpaces();
+            std::string_view key{};
+            if (!readKey(key))
+                return "expected a \"key\"";
+            if (!consume(':'))
+                return "expected ':' after a key";
+            skipSpaces();
+
+            bool ok{ false };
+            unsigned bit{ 0 };
+            if (key == "id")
+                bit = 1, ok = readNumber(e.id);
+            else if (key == "age")
+                bit = 2, ok = readNumber(e.age);
+            else if (key == "wage")
+                bit = 4, ok = readNumber(e.wage);
+            else
+                return "unknown key";
+            if (!ok)
+                return "value is not a number of the right kind";
+            if (seen & bit)
+                return "key appears twice";
+            seen |= bit;
+
+            if (consume(','))
+                continue;
+            if (consume('}'))
+                break;
+            return "expected ',' or '}'";
+        }
+
+        skipSpaces();
+        if (m_pos != m_line.size())
+            return "text after the closing '}'";
+        if (seen != 7)
+            return "missing id, age or wage";
+        return nullptr;
+    }
+
+private:
+    void skipSpaces()
+    {
+        while (m_pos < m_line.size() && (m_line[m_pos] == ' ' || m_line[m_pos] == '\t'))
+            ++m_pos;
+    }
+
+    bool consume(char ch)
+    {
+        skipSpaces();
+        if (m_pos < m_line.size() && m_line[m_pos] == ch)
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool readKey(std::string_view& key)
+    {
+        if (m_pos >= m_line.size() || m_line[m_pos] != '"')
+            return false;
+        const std::size_t close{ m_line.find('"', m_pos + 1) };
+        if (close == std::string_view::npos)
+            return false;
+        key = m_line.substr(m_pos + 1, close - m_pos - 1);
+        m_pos = close + 1;
+        return key.find('\\') == std::string_view::npos;
+    }
+
+    template <typename T>
+    bool readNumber(T& value)
+    {
+        const char* end{ m_line.data() + m_line.size() };
+        const auto [ptr, ec]{ std::from_chars(m_line.data() + m_pos, end, value) };
+        if (ec != std::errc{})
+            return false;
+        m_pos = static_cast<std::size_t>(ptr - m_line.data());
+        // "12.5" isn't an int: from_chars stops at the '.', which the caller would then choke on
+        return m_pos == m_line.size() || m_line[m_pos] == ',' || m_line[m_pos] == '}' || m_line[m_pos] == ' ' || m_line[m_pos] == '\t';
+    }
+
+    std::string_view m_line{};
+    std::size_t m_pos{ 0 };
+};
+
+LoadResult loadJsonLines(std::string_view text, ScanFn scan = bestScanner())
+{
+    LoadResult result{};
+    std::size_t line{ 1 };
+    std::size_t lineStart{ 0 };
+
+    auto parseLine = [&](std::size_t end) {
+        const std::string_view row{ stripCarriageReturn(text.substr(lineStart, end - lineStart)) };
+        if (!row.empty()) // blank lines are fine
+        {
+            Employee e{};
+            if (const char* reason{ JsonLineParser{ row }.parse(e) })
+                result.errors.push_back({ line, reason });
+            else
+                result.employees.push_back(e);
+        }
+        ++line;
+        lineStart = end + 1;
+    };
+
+    forEachBlock(text, scan, [&](std::size_t blockStart, BlockMasks masks) {
+        std::uint64_t newlines{ masks.newlines };
+        while (newlines != 0)
+        {
+            parseLine(blockStart + static_cast<std::size_t>(__builtin_ctzll(newlines)));
+            newlines &= newlines - 1;
+        }
+    });
+    if (lineStart < text.size())
+        parseLine(text.size());
+    return result;
+}
+
+// ----------------------------------------------------------------------------------------------
+// The obvious way with streams, as a baseline
+
+void writeCsvStream(std::ostream& out, const std::vector<Employee>& employees)
+{
+    out << csvHeader << '\n';
+    out.precision(17); // enough digits that every double reads back the same
+    for (const Employee& e : employees)
+        out << e.id << ',' << e.age << ',' << e.wage << '\n';
+}
+
+std::vector<Employee> loadCsvStream(const std::string& text)
+{
+    std::istringstream in{ text };
+    std::string line{};
+    std::getline(in, line); // header
+    std::vector<Employee> employees{};
+    char comma1{};
+    char comma2{};
+    Employee e{};
+    while (std::getline(in, line))
+    {
+        std::istringstream fields{ line };
+        if (fields >> e.id >> comma1 >> e.age >> comma2 >> e.wage)
+            employees.push_back(e);
+    }
+    return employees;
+}
+
+// ----------------------------------------------------------------------------------------------
+
+std::vector<Employee> makeEmployees(std::size_t count)
+{
+    std::mt19937_64 mt{ 13 };
+    std::uniform_int_distribution<int> ages{ 18, 70 };
+    std::uniform_int_distribution<int> cents{ 2'000'000, 25'000'000 };
+    std::vector<Employee> employees(count);
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        employees[i].id = static_cast<int>(i) + 1;
+        employees[i].age = ages(mt);
+        // Mostly whole cents, sometimes a wage with all 17 digits (like 1/3 of a salary)
+        employees[i].wage = (mt() % 16 == 0) ? cents(mt) / 300.0 : cents(mt) / 100.0;
+    }
+    // The extremes must survive too
+    employees[0] = { -2147483647 - 1, 0, 0.0 };
+    employees[1] = { 2147483647, -1, -1e-300 };
+    employees[2] = { 7, 120, 1.7976931348623157e308 };
+    return employees;
+}
+
+bool sameEmployees(const std::vector<Employee>& a, const std::vector<Employee>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (std::size_t i{ 0 }; i < a.size(); ++i)
+    {
+        if (!(a[i] == b[i]))
+            return false;
+    }
+    return true;
+}
+
+void printErrors(const char* name, const LoadResult& result)
+{
+    std::cout << name << ": " << result.employees.size() << " rows loaded, " << result.errors.size() << " errors\n";
+    for (const RowError& error : result.errors)
+        std::cout << "    line " << error.line << ": " << error.reason << '\n';
+}
+
+template <typename Fn>
+double seconds(Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    fn();
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    return elapsed.count();
+}
+
+void report(const char* name, std::size_t bytes, std::size_t rows, double time)
+{
+    std::cout << name << bytes / time / 1e9 << " GB/s, " << rows / time / 1e6 << " M rows/sec\n";
+}
+
+int main()
+{
+    // Bad rows are skipped and reported, the good ones around them still load
+    const std::string badCsv{
+        "id,age,wage\n"
+        "1,30,50000\n"
+        "2,31\n"
+        "3,x,100\n"
+        "\n"
+        "4,25,1e5\r\n"
+        "5,40,12.5,9\n"
+        "6,22,7000.25"
+    };
+    printErrors("bad CSV", loadCsv(badCsv));
+
+    const std::string badJson{
+        "{\"id\":1,\"age\":30,\"wage\":50000}\n"
+        "{ \"wage\": 1.5, \"id\": 2, \"age\": 44 }\n"
+        "{\"id\":3,\"age\":30.5,\"wage\":1}\n"
+        "{\"id\":4,\"age\":30}\n"
+        "{\"id\":5,\"age\":30,\"wage\":1,\"boss\":2}\n"
+        "{\"id\":6,\"age\":30,\"wage\":1} x\n"
+    };
+    printErrors("bad JSON lines", loadJsonLines(badJson));
+
+    // Round trip: write, read back, compare every field bit for bit
+    const std::vector<Employee> employees{ makeEmployees(5'000'000) };
+    std::ostringstream csvOut{};
+    std::ostringstream jsonOut{};
+    const double csvWriteTime{ seconds([&] { writeCsv(csvOut, employees.data(), employees.size()); }) };
+    const double jsonWriteTime{ seconds([&] { writeJsonLines(jsonOut, employees.data(), employees.size()); }) };
+    const std::string csv{ csvOut.str() };
+    const std::string json{ jsonOut.str() };
+
+    std::cout << "\n" << employees.size() << " employees, scan kernel: "
+              << CpuFeatures::tierName(CpuFeatures::selectedTier(scanImpls)) << '\n';
+    for (ScanFn scan : { scanImpls.scalar, bestScanner() })
+    {
+        const LoadResult fromCsv{ loadCsv(csv, scan) };
+        const LoadResult fromJson{ loadJsonLines(json, scan) };
+        std::cout << "round trip (" << (scan == scanImpls.scalar ? "scalar" : "best") << " scan): CSV "
+                  << (fromCsv.errors.empty() && sameEmployees(fromCsv.employees, employees) ? "identical" : "DIFFERENT")
+                  << ", JSON lines "
+                  << (fromJson.errors.empty() && sameEmployees(fromJson.employees, employees) ? "identical" : "DIFFERENT") << '\n';
+    }
+
+    // Throughput
+    std::cout << '\n';
+    report("write CSV, to_chars:           ", csv.size(), employees.size(), csvWriteTime);
+    report("write JSON lines, to_chars:    ", json.size(), employees.size(), jsonWriteTime);
+    std::ostringstream streamOut{};
+    report("write CSV, operator<<:         ", csv.size(), employees.size(), seconds([&] { writeCsvStream(streamOut, employees); }));
+
+    std::size_t loaded{ 0 };
+    report("load CSV, scalar scan:         ", csv.size(), employees.size(), seconds([&] { loaded += loadCsv(csv, scanImpls.scalar).employees.size(); }));
+    report("load CSV, SIMD scan:           ", csv.size(), employees.size(), seconds([&] { loaded += loadCsv(csv).employees.size(); }));
+    report("load JSON lines, SIMD scan:    ", json.size(), employees.size(), seconds([&] { loaded += loadJsonLines(json).employees.size(); }));
+    report("load CSV, getline + >>:        ", csv.size(), employees.size(), seconds([&] { loaded += loadCsvStream(csv).size(); }));
+    std::cout << "(" << loaded << " rows loaded in total)\n";
+
+    return 0;
+}
+
+/* Sample results (5 million employees, one slow core with AVX-512):
+write CSV, to_chars:           0.134 GB/s, 6.5 M rows/sec
+write JSON lines, to_chars:    0.221 GB/s, 5.4 M rows/sec
+write CSV, operator<<:         0.019 GB/s, 0.92 M rows/sec
+load CSV, scalar scan:         0.122 GB/s, 5.9 M rows/sec
+load CSV, SIMD scan:           0.168 GB/s, 8.1 M rows/sec
+load JSON lines, SIMD scan:    0.220 GB/s, 5.4 M rows/sec
+load CSV, getline + >>:        0.016 GB/s, 0.77 M rows/sec
+
+Finding the separators is nearly free once it's SIMD; what's left is from_chars, about 40 ns
+per row on this machine. Faster cores run the same code several times quicker.
+*/
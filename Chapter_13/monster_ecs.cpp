@@ -0,0 +1,483 @@
+// quiz_q1.cpp stops at an empty struct Monster. The obvious next step is one struct with every
+// field a monster has (type, name, health, position, velocity, ...) and a std::vector<Monster>.
+// That's fine for a few monsters, but when hundreds of thousands are updated every tick, the
+// movement code drags names and health through the cache just to read positions.
+//
+// An entity-component store splits a monster into pieces instead:
+//   - an Entity is just an id (an index plus a "generation", see below)
+//   - each kind of component (Position, Velocity, Health, ...) lives in its own dense array,
+//     so a system that only needs Position and Velocity only touches those two arrays
+//   - a "system" is a loop over every entity that has a given set of components
+//
+// Generations: when an entity is destroyed, its index is reused for the next one created.
+// Every reuse bumps the generation, so an old Entity handle for that index stops being alive()
+// instead of silently pointing at whichever monster got the slot next.
+//
+// Build with -O2 -pthread.
+
+#include <algorithm> // for std::min
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // for std::function
+#include <iomanip>    // for std::setw
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility> // for std::move
+#include <vector>
+
+struct Entity
+{
+    std::uint32_t index{};
+    std::uint32_t generation{};
+};
+
+// ---- Components ----
+
+enum class MonsterType
+{
+    ogre,
+    dragon,
+    orc,
+    giant_spider,
+    slime,
+    max_monster_types,
+};
+
+constexpr std::string_view getMonsterName(MonsterType type)
+{
+    switch (type)
+    {
+        case MonsterType::ogre:         return "ogre";
+        case MonsterType::dragon:       return "dragon";
+        case MonsterType::orc:          return "orc";
+        case MonsterType::giant_spider: return "giant spider";
+        case MonsterType::slime:        return "slime";
+        default:                        return "???";
+    }
+}
+
+struct Position
+{
+    float x{};
+    float y{};
+};
+
+struct Velocity
+{
+    float dx{};
+    float dy{};
+};
+
+struct Health
+{
+    float hp{};
+    float regenPerSecond{};
+};
+
+struct Poisoned
+{
+    float damagePerSecond{};
+    float secondsLeft{};
+};
+
+// ---- One dense array per component type ----
+// A "sparse set": dense holds the components back to back, owners[i] is the entity index that
+// owns dense[i], and sparse[entity index] is the slot in dense (or npos). Removing swaps the last
+// element into the hole, so dense never has gaps.
+
+template <typename T>
+class ComponentPool
+{
+public:
+    static constexpr std::uint32_t npos{ std::numeric_limits<std::uint32_t>::max() };
+
+    std::size_t size() const { return m_dense.size(); }
+
+    bool has(std::uint32_t index) const { return slotOf(index) != npos; }
+
+    std::uint32_t slotOf(std::uint32_t index) const
+    {
+        return index < m_sparse.size() ? m_sparse[index] : npos;
+    }
+
+    // Same as slotOf(), but tries the slot "hint" first. Pools whose entities were added in the
+    // same order line up slot for slot, so iterating several of them together skips the lookup.
+    std::uint32_t slotOf(std::uint32_t index, std::size_t hint) const
+    {
+        if (hint < m_owners.size() && m_owners[hint] == index)
+            return static_cast<std::uint32_t>(hint);
+        return slotOf(index);
+    }
+
+    void add(std::uint32_t index, const T& component)
+    {
+        if (index >= m_sparse.size())
+            m_sparse.resize(index + 1, npos);
+
+        if (m_sparse[index] != npos)
+        {
+            m_dense[m_sparse[index]] = component;
+            return;
+        }
+        m_sparse[index] = static_cast<std::uint32_t>(m_dense.size());
+        m_dense.push_back(component);
+        m_owners.push_back(index);
+    }
+
+    void remove(std::uint32_t index)
+    {
+        const std::uint32_t slot{ slotOf(index) };
+        if (slot == npos)
+            return;
+
+        const std::uint32_t last{ static_cast<std::uint32_t>(m_dense.size() - 1) };
+        m_dense[slot] = std::move(m_dense[last]);
+        m_owners[slot] = m_owners[last];
+        m_sparse[m_owners[slot]] = slot;
+
+        m_dense.pop_back();
+        m_owners.pop_back();
+        m_sparse[index] = npos;
+    }
+
+    T& atSlot(std::size_t slot) { return m_dense[slot]; }
+    std::uint32_t ownerOf(std::size_t slot) const { return m_owners[slot]; }
+
+    void reserve(std::size_t count)
+    {
+        m_dense.reserve(count);
+        m_owners.reserve(count);
+        m_sparse.reserve(count);
+    }
+
+private:
+    std::vector<T> m_dense{};
+    std::vector<std::uint32_t> m_owners{};
+    std::vector<std::uint32_t> m_sparse{};
+};
+
+// ---- The world: entities plus one pool per component type ----
+
+template <typename... Components>
+class World
+{
+public:
+    Entity create()
+    {
+        if (!m_freeList.empty())
+        {
+            const std::uint32_t index{ m_freeList.back() };
+            m_freeList.pop_back();
+            return { index, m_generations[index] };
+        }
+        m_generations.push_back(0);
+        return { static_cast<std::uint32_t>(m_generations.size() - 1), 0 };
+    }
+
+    bool alive(Entity entity) const
+    {
+        return entity.index < m_generations.size() && m_generations[entity.index] == entity.generation;
+    }
+
+    void destroy(Entity entity)
+    {
+        if (!alive(entity))
+            return;
+        (pool<Components>().remove(entity.index), ...);
+        ++m_generations[entity.index]; // any Entity handles still holding the old generation are now dead
+        m_freeList.push_back(entity.index);
+    }
+
+    std::size_t size() const { return m_generations.size() - m_freeList.size(); }
+
+    template <typename T>
+    void add(Entity entity, const T& component)
+    {
+        if (alive(entity))
+            pool<T>().add(entity.index, component);
+    }
+
+    template <typename T>
+    void remove(Entity entity)
+    {
+        if (alive(entity))
+            pool<T>().remove(entity.index);
+    }
+
+    // Returns nullptr if the entity is dead or doesn't have a T
+    template <typename T>
+    T* get(Entity entity)
+    {
+        if (!alive(entity))
+            return nullptr;
+        const std::uint32_t slot{ pool<T>().slotOf(entity.index) };
+        return slot == ComponentPool<T>::npos ? nullptr : &pool<T>().atSlot(slot);
+    }
+
+    template <typename T>
+    ComponentPool<T>& pool() { return std::get<ComponentPool<T>>(m_pools); }
+
+    void reserve(std::size_t count)
+    {
+        m_generations.reserve(count);
+        (pool<Components>().reserve(count), ...);
+    }
+
+    // Call fn(entity, first&, rest&...) for every entity that has all of the listed components.
+    // The loop walks First's dense array, so put the rarest component first.
+    template <typename First, typename... Rest, typename Fn>
+    void each(Fn fn)
+    {
+        eachInRange<First, Rest...>(0, pool<First>().size(), fn);
+    }
+
+    // Same as each(), but the First pool is split into one chunk per core. fn must only touch
+    // the components of the entity it's given (it can't create or destroy entities).
+    template <typename First, typename... Rest, typename Fn>
+    void parallelEach(Fn fn)
+    {
+        const std::size_t count{ pool<First>().size() };
+        const std::size_t numThreads{ std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count / minChunk + 1) };
+        const std::size_t chunk{ (count + numThreads - 1) / numThreads };
+
+        std::vector<std::thread> threads{};
+        for (std::size_t t{ 1 }; t < numThreads; ++t)
+        {
+            const std::size_t begin{ t * chunk };
+            const std::size_t end{ std::min(count, begin + chunk) };
+            threads.emplace_back([this, begin, end, &fn] { eachInRange<First, Rest...>(begin, end, fn); });
+        }
+        eachInRange<First, Rest...>(0, std::min(count, chunk), fn); // this thread takes the first chunk
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+private:
+    static constexpr std::size_t minChunk{ 16384 }; // below this, starting a thread costs more than it saves
+
+    template <typename First, typename... Rest, typename Fn>
+    void eachInRange(std::size_t begin, std::size_t end, Fn& fn)
+    {
+        ComponentPool<First>& first{ pool<First>() };
+        for (std::size_t i{ begin }; i < end; ++i)
+        {
+            const std::uint32_t index{ first.ownerOf(i) };
+            const std::tuple slots{ pool<Rest>().slotOf(index, i)... };
+            std::apply([&](auto... slot) {
+                if (((slot == ComponentPool<Rest>::npos) || ...))
+                    return;
+                fn(Entity{ index, m_generations[index] }, first.atSlot(i), pool<Rest>().atSlot(slot)...);
+            }, slots);
+        }
+    }
+
+    std::vector<std::uint32_t> m_generations{};
+    std::vector<std::uint32_t> m_freeList{};
+    std::tuple<ComponentPool<Components>...> m_pools{};
+};
+
+using MonsterWorld = World<MonsterType, Position, Velocity, Health, Poisoned>;
+
+// ---- Systems and the scheduler that runs them each tick ----
+
+class Scheduler
+{
+public:
+    void addSystem(std::string name, std::function<void(float)> system)
+    {
+        m_systems.push_back({ std::move(name), std::move(system), 0.0 });
+    }
+
+    void tick(float dt)
+    {
+        for (System& system : m_systems)
+        {
+            const auto start{ std::chrono::steady_clock::now() };
+            system.run(dt);
+            const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+            system.seconds += elapsed.count();
+        }
+    }
+
+    void printTimes(int ticks) const
+    {
+        for (const System& system : m_systems)
+            std::cout << "    " << std::setw(10) << system.name << std::setw(10) << system.seconds / ticks * 1e3 << " ms/tick\n";
+    }
+
+private:
+    struct System
+    {
+        std::string name{};
+        std::function<void(float)> run{};
+        double seconds{};
+    };
+    std::vector<System> m_systems{};
+};
+
+constexpr float worldSize{ 1000.0f };
+
+Entity spawnMonster(MonsterWorld& world, std::mt19937& mt)
+{
+    std::uniform_real_distribution<float> coordinate{ 0.0f, worldSize };
+    std::uniform_real_distribution<float> speed{ -5.0f, 5.0f };
+    const auto type{ static_cast<MonsterType>(mt() % static_cast<unsigned>(MonsterType::max_monster_types)) };
+
+    const Entity monster{ world.create() };
+    world.add(monster, type);
+    world.add(monster, Position{ coordinate(mt), coordinate(mt) });
+    world.add(monster, Velocity{ speed(mt), speed(mt) });
+    world.add(monster, Health{ type == MonsterType::dragon ? 500.0f : 100.0f, 1.0f });
+    if (mt() % 8 == 0)
+        world.add(monster, Poisoned{ 30.0f, 10.0f });
+    return monster;
+}
+
+// Wires up the per-tick systems. parallel chooses each() or parallelEach() for the heavy ones.
+void addSystems(Scheduler& scheduler, MonsterWorld& world, std::mt19937& mt, bool parallel)
+{
+    scheduler.addSystem("movement", [&world, parallel](float dt) {
+        auto move{ [dt](Entity, Position& p, Velocity& v) {
+            p.x += v.dx * dt;
+            p.y += v.dy * dt;
+            // Bounce off the edges of the world
+            if (p.x < 0.0f || p.x > worldSize) v.dx = -v.dx;
+            if (p.y < 0.0f || p.y > worldSize) v.dy = -v.dy;
+        } };
+        parallel ? world.parallelEach<Position, Velocity>(move) : world.each<Position, Velocity>(move);
+    });
+
+    scheduler.addSystem("poison", [&world](float dt) {
+        // Few monsters are poisoned, so Poisoned goes first and this loop is short
+        world.each<Poisoned, Health>([dt](Entity, Poisoned& poison, Health& health) {
+            if (poison.secondsLeft > 0.0f)
+            {
+                health.hp -= poison.damagePerSecond * dt;
+                poison.secondsLeft -= dt;
+            }
+        });
+    });
+
+    scheduler.addSystem("regen", [&world, parallel](float dt) {
+        auto regen{ [dt](Entity, Health& health) { health.hp += health.regenPerSecond * dt; } };
+        parallel ? world.parallelEach<Health>(regen) : world.each<Health>(regen);
+    });
+
+    // Destroying changes the pools, so it can't happen inside a (parallel) loop: collect first, then destroy
+    scheduler.addSystem("cleanup", [&world, &mt](float) {
+        std::vector<Entity> dead{};
+        world.each<Health>([&dead](Entity e, Health& health) {
+            if (health.hp <= 0.0f)
+                dead.push_back(e);
+        });
+        for (Entity e : dead)
+        {
+            world.destroy(e);
+            spawnMonster(world, mt); // keep the population steady
+        }
+    });
+}
+
+// The "one big struct" version, for comparison
+struct Monster
+{
+    MonsterType type{};
+    std::string name{};
+    Health health{};
+    Position position{};
+    Velocity velocity{};
+    Poisoned poisoned{};
+    bool isPoisoned{};
+};
+
+int main()
+{
+    // Generations in action
+    {
+        MonsterWorld world{};
+        std::mt19937 mt{ 1 };
+        const Entity first{ spawnMonster(world, mt) };
+        std::cout << "Spawned: " << getMonsterName(*world.get<MonsterType>(first)) << '\n';
+        world.destroy(first);
+        const Entity second{ spawnMonster(world, mt) };
+        std::cout << "Reused index " << second.index << ": old handle alive? " << std::boolalpha << world.alive(first)
+                  << ", get() on it gives " << (world.get<Position>(first) ? "a Position" : "nullptr") << "\n\n";
+    }
+
+    constexpr int numMonsters{ 1'000'000 };
+    constexpr int ticks{ 100 };
+    constexpr float dt{ 1.0f / 60.0f };
+
+    std::cout << numMonsters << " monsters, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    for (bool parallel : { false, true })
+    {
+        MonsterWorld world{};
+        std::mt19937 mt{ 42 };
+        world.reserve(numMonsters);
+        for (int i{ 0 }; i < numMonsters; ++i)
+            spawnMonster(world, mt);
+
+        Scheduler scheduler{};
+        addSystems(scheduler, world, mt, parallel);
+
+        const auto start{ std::chrono::steady_clock::now() };
+        for (int t{ 0 }; t < ticks; ++t)
+            scheduler.tick(dt);
+        const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+        std::cout << (parallel ? "ECS, parallel:  " : "ECS, 1 thread:  ") << ticks / elapsed.count() << " ticks/sec ("
+                  << world.size() << " alive)\n";
+        scheduler.printTimes(ticks);
+    }
+
+    // Same movement + poison + regen work on a std::vector<Monster>
+    {
+        std::mt19937 mt{ 42 };
+        std::uniform_real_distribution<float> coordinate{ 0.0f, worldSize };
+        std::uniform_real_distribution<float> speed{ -5.0f, 5.0f };
+        std::vector<Monster> monsters(numMonsters);
+        for (Monster& m : monsters)
+        {
+            m.type = static_cast<MonsterType>(mt() % static_cast<unsigned>(MonsterType::max_monster_types));
+            m.name = getMonsterName(m.type);
+            m.health = { 100.0f, 1.0f };
+            m.position = { coordinate(mt), coordinate(mt) };
+            m.velocity = { speed(mt), speed(mt) };
+            m.isPoisoned = (mt() % 8 == 0);
+            m.poisoned = { 30.0f, 10.0f };
+        }
+
+        const auto start{ std::chrono::steady_clock::now() };
+        for (int t{ 0 }; t < ticks; ++t)
+        {
+            for (Monster& m : monsters)
+            {
+                m.position.x += m.velocity.dx * dt;
+                m.position.y += m.velocity.dy * dt;
+                if (m.position.x < 0.0f || m.position.x > worldSize) m.velocity.dx = -m.velocity.dx;
+                if (m.position.y < 0.0f || m.position.y > worldSize) m.velocity.dy = -m.velocity.dy;
+            }
+            for (Monster& m : monsters)
+            {
+                if (m.isPoisoned && m.poisoned.secondsLeft > 0.0f)
+                {
+                    m.health.hp -= m.poisoned.damagePerSecond * dt;
+                    m.poisoned.secondsLeft -= dt;
+                }
+            }
+            for (Monster& m : monsters)
+                m.health.hp += m.health.regenPerSecond * dt;
+        }
+        const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+        std::cout << "vector<Monster> (" << sizeof(Monster) << " bytes each): " << ticks / elapsed.count() << " ticks/sec\n";
+    }
+
+    return 0;
+}
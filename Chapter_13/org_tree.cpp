@@ -0,0 +1,361 @@
+// Company in nested_structs.cpp only knows its number of employees and one Employee CEO.
+// A real company is a tree: every employee except the CEO has a manager.
+//
+// Storing that tree as nodes with pointers to their children means "total wages of everyone
+// under manager X" has to chase pointers all over memory. Instead, this store lays the tree out
+// flat, in preorder (a manager first, then everything under them, recursively). Then everyone
+// under X sits in one contiguous range [index of X, subtreeEnd of X), and the query is a simple
+// loop over one array.
+//
+// The arrays live in a monotonic arena (std::pmr::monotonic_buffer_resource): one big chunk of
+// memory instead of one allocation per node, and freeing the whole tree is a single release.
+//
+// New employees can be added one at a time. They wait in a small "pending" list that queries also
+// look at, and once that list gets long the whole tree is flattened again.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>          // for std::unique_ptr
+#include <memory_resource> // for std::pmr
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+struct Employee
+{
+    int id{};
+    int age{};
+    double wage{};
+};
+
+struct Hire
+{
+    Employee employee{};
+    int managerId{}; // -1 for the CEO
+};
+
+class OrgStore
+{
+public:
+    // Build the whole tree at once. hires must contain exactly one CEO (managerId -1),
+    // and every other managerId must be the id of someone in hires.
+    explicit OrgStore(const std::vector<Hire>& hires)
+    {
+        flatten(hires);
+    }
+
+    std::size_t size() const { return m_flat->ids.size() + m_pending.size(); }
+
+    // Add one employee under an existing manager. Cheap; the tree is re-flattened now and then.
+    // Returns false (and changes nothing) if the id is already taken or the manager doesn't exist.
+    // Since a manager always has to be there first, pending hires can never form a loop.
+    bool insert(const Hire& hire)
+    {
+        if (contains(hire.employee.id))
+            return false;
+        if (hire.managerId < 0 ? size() != 0 : !contains(hire.managerId))
+            return false; // a second CEO, or a manager nobody has heard of
+
+        m_pending.push_back(hire);
+        m_pendingIndex[hire.employee.id] = m_pending.size() - 1;
+
+        if (m_pending.size() > reflattenThreshold())
+            reflatten();
+        return true;
+    }
+
+    bool contains(int id) const
+    {
+        return m_flat->indexOf.find(id) != m_flat->indexOf.end() || m_pendingIndex.find(id) != m_pendingIndex.end();
+    }
+
+    // Sum of the wages of managerId and everyone (directly or indirectly) under them
+    double totalWagesUnder(int managerId) const
+    {
+        double total{ 0.0 };
+
+        const auto found{ m_flat->indexOf.find(managerId) };
+        if (found != m_flat->indexOf.end())
+        {
+            const std::size_t begin{ found->second };
+            const std::size_t end{ m_flat->subtreeEnd[begin] };
+            // The contiguous range scan this whole layout is for
+            for (std::size_t i{ begin }; i < end; ++i)
+                total += m_flat->wages[i];
+        }
+
+        // Pending hires aren't in the arrays yet, so check each one's chain of managers
+        for (const Hire& hire : m_pending)
+        {
+            if (reportsTo(hire, managerId))
+                total += hire.employee.wage;
+        }
+        return total;
+    }
+
+    // Number of people in managerId's subtree, including managerId
+    std::size_t headcountUnder(int managerId) const
+    {
+        std::size_t count{ 0 };
+        const auto found{ m_flat->indexOf.find(managerId) };
+        if (found != m_flat->indexOf.end())
+            count = m_flat->subtreeEnd[found->second] - found->second;
+
+        for (const Hire& hire : m_pending)
+            count += reportsTo(hire, managerId);
+        return count;
+    }
+
+    void reflatten()
+    {
+        std::vector<Hire> hires{};
+        hires.reserve(size());
+        for (std::size_t i{ 0 }; i < m_flat->ids.size(); ++i)
+            hires.push_back({ { m_flat->ids[i], m_flat->ages[i], m_flat->wages[i] }, m_flat->managerIds[i] });
+        hires.insert(hires.end(), m_pending.begin(), m_pending.end());
+
+        flatten(hires);
+        m_pending.clear();
+        m_pendingIndex.clear();
+    }
+
+private:
+    // Everything lives in the arena. Columns are separate arrays (struct of arrays), so the
+    // wage scan only pulls wages through the cache, not ids and ages too.
+    struct Flat
+    {
+        std::pmr::monotonic_buffer_resource arena{};
+        std::pmr::vector<int> ids{ &arena };
+        std::pmr::vector<int> ages{ &arena };
+        std::pmr::vector<double> wages{ &arena };
+        std::pmr::vector<int> managerIds{ &arena };
+        std::pmr::vector<std::size_t> subtreeEnd{ &arena }; // one past the last index under this node
+        std::pmr::unordered_map<int, std::size_t> indexOf{ &arena };
+    };
+
+    std::size_t reflattenThreshold() const
+    {
+        // Pending hires cost a manager-chain walk per query, so don't let too many pile up
+        return std::max<std::size_t>(64, m_flat->ids.size() / 256);
+    }
+
+    // True if hire's chain of managers (through other pending hires, then into the flat tree) reaches managerId
+    bool reportsTo(const Hire& hire, int managerId) const
+    {
+        if (hire.employee.id == managerId)
+            return true;
+
+        int boss{ hire.managerId };
+        while (true)
+        {
+            if (boss == managerId)
+                return true;
+
+            const auto pending{ m_pendingIndex.find(boss) };
+            if (pending != m_pendingIndex.end())
+            {
+                boss = m_pending[pending->second].managerId;
+                continue;
+            }
+
+            // boss is in the flat tree: it's under managerId if its index is inside managerId's range
+            const auto bossIndex{ m_flat->indexOf.find(boss) };
+            const auto managerIndex{ m_flat->indexOf.find(managerId) };
+            if (bossIndex == m_flat->indexOf.end() || managerIndex == m_flat->indexOf.end())
+                return false;
+            return bossIndex->second >= managerIndex->second && bossIndex->second < m_flat->subtreeEnd[managerIndex->second];
+        }
+    }
+
+    void flatten(const std::vector<Hire>& hires)
+    {
+        const std::size_t n{ hires.size() };
+
+        // Children lists in "compressed" form: the children of hire h are
+        // childList[firstChild[h] .. firstChild[h + 1]), so no vector per node
+        std::unordered_map<int, std::size_t> hireIndex{};
+        hireIndex.reserve(n);
+        for (std::size_t h{ 0 }; h < n; ++h)
+            hireIndex[hires[h].employee.id] = h;
+
+        std::vector<std::size_t> firstChild(n + 1, 0);
+        std::size_t root{ n };
+        for (std::size_t h{ 0 }; h < n; ++h)
+        {
+            if (hires[h].managerId < 0)
+                root = h;
+            else
+                ++firstChild[hireIndex.at(hires[h].managerId) + 1];
+        }
+        for (std::size_t h{ 0 }; h < n; ++h)
+            firstChild[h + 1] += firstChild[h];
+
+        std::vector<std::size_t> childList(n);
+        std::vector<std::size_t> fill{ firstChild.begin(), firstChild.end() - 1 };
+        for (std::size_t h{ 0 }; h < n; ++h)
+        {
+            if (hires[h].managerId >= 0)
+                childList[fill[hireIndex.at(hires[h].managerId)]++] = h;
+        }
+
+        auto flat{ std::make_unique<Flat>() };
+        flat->ids.reserve(n);
+        flat->ages.reserve(n);
+        flat->wages.reserve(n);
+        flat->managerIds.reserve(n);
+        flat->subtreeEnd.resize(n);
+        flat->indexOf.reserve(n);
+
+        if (root == n)
+        {
+            m_flat = std::move(flat);
+            return;
+        }
+
+        // Preorder with our own stack instead of recursion, since the tree can be millions deep in theory.
+        // A stack entry is (hire, next child to visit). When all children are done, the subtree ends here.
+        struct Frame
+        {
+            std::size_t hire{};
+            std::size_t nextChild{};
+            std::size_t flatIndex{};
+        };
+        std::vector<Frame> stack{};
+
+        auto visit{ [&](std::size_t h) {
+            const Hire& hire{ hires[h] };
+            const std::size_t index{ flat->ids.size() };
+            flat->ids.push_back(hire.employee.id);
+            flat->ages.push_back(hire.employee.age);
+            flat->wages.push_back(hire.employee.wage);
+            flat->managerIds.push_back(hire.managerId);
+            flat->indexOf[hire.employee.id] = index;
+            stack.push_back({ h, firstChild[h], index });
+        } };
+
+        visit(root);
+        while (!stack.empty())
+        {
+            Frame& top{ stack.back() };
+            if (top.nextChild < firstChild[top.hire + 1])
+            {
+                visit(childList[top.nextChild++]); // careful: may reallocate the stack, so top is not used after this
+            }
+            else
+            {
+                flat->subtreeEnd[top.flatIndex] = flat->ids.size();
+                stack.pop_back();
+            }
+        }
+
+        m_flat = std::move(flat); // the old arena (and everything in it) is released here in one go
+    }
+
+    std::unique_ptr<Flat> m_flat{};
+    std::vector<Hire> m_pending{};
+    std::unordered_map<int, std::size_t> m_pendingIndex{};
+};
+
+struct Company
+{
+    int numberOfEmployees{};
+    Employee CEO{};
+    OrgStore org;
+};
+
+// The pointer-based tree, for comparison
+struct Node
+{
+    double wage{};
+    std::vector<Node*> reports{};
+};
+
+double totalWagesRecursive(const Node* node)
+{
+    double total{ node->wage };
+    for (const Node* report : node->reports)
+        total += totalWagesRecursive(report);
+    return total;
+}
+
+int main()
+{
+    // Small example: a CEO, two VPs, and some staff
+    const std::vector<Hire> small{
+        { { 1, 52, 300000.0 }, -1 },
+        { { 2, 45, 180000.0 }, 1 },
+        { { 3, 41, 170000.0 }, 1 },
+        { { 4, 30, 90000.0 }, 2 },
+        { { 5, 28, 85000.0 }, 2 },
+        { { 6, 35, 95000.0 }, 3 },
+    };
+    Company myCompany{ 6, small[0].employee, OrgStore{ small } };
+    std::cout << "CEO's wage: " << myCompany.CEO.wage << '\n';
+    std::cout << "Wages under VP 2: " << myCompany.org.totalWagesUnder(2) << '\n'; // 355000
+
+    myCompany.org.insert({ { 7, 22, 60000.0 }, 5 });
+    std::cout << "After hiring under 5: " << myCompany.org.totalWagesUnder(2) << " (" << myCompany.org.headcountUnder(2) << " people)\n";
+    const bool duplicate{ myCompany.org.insert({ { 7, 23, 1.0 }, 1 }) };
+    const bool noManager{ myCompany.org.insert({ { 8, 23, 1.0 }, 99 }) };
+    const bool secondCeo{ myCompany.org.insert({ { 9, 23, 1.0 }, -1 }) };
+    std::cout << "Rejected a duplicate id, an unknown manager and a second CEO: "
+              << (!duplicate && !noManager && !secondCeo && myCompany.org.size() == 7 ? "yes" : "NO") << "\n\n";
+
+    // Benchmark: 2M employees, each managed by a random earlier hire
+    constexpr int numEmployees{ 2'000'000 };
+    std::mt19937 mt{ 11 };
+    std::vector<Hire> hires{};
+    hires.reserve(numEmployees);
+    hires.push_back({ { 0, 60, 500000.0 }, -1 });
+    for (int id{ 1 }; id < numEmployees; ++id)
+    {
+        // Skewed towards recent hires, so the tree gets deep as well as wide
+        const int span{ std::min(id, 1000) };
+        const int manager{ id - 1 - static_cast<int>(mt() % static_cast<unsigned>(span)) };
+        hires.push_back({ { id, 20 + static_cast<int>(mt() % 45), 40000.0 + static_cast<double>(mt() % 100000) }, manager });
+    }
+
+    auto start{ std::chrono::steady_clock::now() };
+    OrgStore store{ hires };
+    std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    std::cout << "bulk build of " << store.size() << " employees: " << elapsed.count() * 1e3 << " ms\n";
+
+    std::vector<Node> nodes(numEmployees);
+    for (const Hire& hire : hires)
+    {
+        nodes[static_cast<std::size_t>(hire.employee.id)].wage = hire.employee.wage;
+        if (hire.managerId >= 0)
+            nodes[static_cast<std::size_t>(hire.managerId)].reports.push_back(&nodes[static_cast<std::size_t>(hire.employee.id)]);
+    }
+
+    // Managers near the top have big subtrees, so query a mix of ids
+    std::vector<int> queries{};
+    for (int i{ 0 }; i < 200; ++i)
+        queries.push_back(static_cast<int>(mt() % 2000));
+
+    double flatSum{ 0.0 };
+    start = std::chrono::steady_clock::now();
+    for (int id : queries)
+        flatSum += store.totalWagesUnder(id);
+    const std::chrono::duration<double> flatTime{ std::chrono::steady_clock::now() - start };
+
+    double treeSum{ 0.0 };
+    start = std::chrono::steady_clock::now();
+    for (int id : queries)
+        treeSum += totalWagesRecursive(&nodes[static_cast<std::size_t>(id)]);
+    const std::chrono::duration<double> treeTime{ std::chrono::steady_clock::now() - start };
+
+    std::cout << "subtree wage queries: flat " << flatTime.count() * 1e3 << " ms, pointer tree " << treeTime.count() * 1e3
+              << " ms (" << (flatSum == treeSum ? "same answers" : "DIFFERENT answers!") << ")\n";
+
+    // Incremental inserts, with re-flattening every few thousand
+    start = std::chrono::steady_clock::now();
+    for (int id{ numEmployees }; id < numEmployees + 20'000; ++id)
+        store.insert({ { id, 25, 50000.0 }, static_cast<int>(mt() % static_cast<unsigned>(id)) });
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "20000 incremental inserts: " << elapsed.count() * 1e3 << " ms, CEO now over " << store.headcountUnder(0) << " people\n";
+
+    return 0;
+}
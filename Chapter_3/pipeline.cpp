@@ -0,0 +1,470 @@
+// quiz_q1.cpp and quiz_q2.cpp: readNumber() twice, compute, writeAnswer(). One pair per run, typed in by hand.
+// This does the same for a whole file of pairs ("x y" on each line), split into three stages that run
+// at the same time on different threads:
+//
+//   reader  -> reads the file in big chunks, cut at a newline so no line is split in two
+//   workers -> each parses its chunks and computes the answers (sum or quotient)
+//   writer  -> writes the answers out in the original order
+//
+// The stages are connected by small fixed-size queues. When a queue is full, the stage feeding it
+// waits ("backpressure"), so a slow writer can't make the reader pull the whole file into memory.
+//
+// Each queue has exactly one thread pushing and one thread popping, which makes it easy to write
+// without a lock: the reader deals chunk 0 to worker 0, chunk 1 to worker 1, and so on, and the
+// writer collects them back in the same round-robin order, which also keeps the output in order.
+//
+// Usage: pipeline [sum|quotient] [input file] [output file]
+// With no input file, a ~200 MB sample is generated. Build with -O2 -pthread.
+
+#include <algorithm> // for std::max, std::copy
+#include <array>
+#include <atomic>
+#include <charconv> // for std::from_chars, std::to_chars
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip> // for std::setw
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility> // for std::move, std::pair
+#include <vector>
+#include "../Chapter_4/checked_math.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Fixed-size queue for one producer thread and one consumer thread.
+// head is only written by the consumer and tail only by the producer, so two atomics are enough.
+// They sit on separate cache lines so the two threads don't keep stealing the line from each other.
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+public:
+	bool tryPush(T& item)
+	{
+		const std::size_t tail{ m_tail.load(std::memory_order_relaxed) };
+		if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+			return false; // full
+		m_slots[tail % Capacity] = std::move(item);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPop(T& item)
+	{
+		const std::size_t head{ m_head.load(std::memory_order_relaxed) };
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false; // empty
+		item = std::move(m_slots[head % Capacity]);
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<T, Capacity> m_slots{};
+	alignas(64) std::atomic<std::size_t> m_head{ 0 };
+	alignas(64) std::atomic<std::size_t> m_tail{ 0 };
+};
+
+// How much time a stage spent working vs waiting on a queue
+struct StageStats
+{
+	double busySeconds{};
+	double waitSeconds{};
+	std::size_t items{};
+};
+
+// Keep trying until it works, counting the time spent waiting.
+// yield() instead of pure spinning, so a machine with fewer cores than threads still makes progress.
+template <typename Try>
+void waitFor(Try attempt, StageStats& stats)
+{
+	if (attempt())
+		return;
+	const auto start{ Clock::now() };
+	while (!attempt())
+		std::this_thread::yield();
+	stats.waitSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Chunk
+{
+	std::string text{};
+	bool last{ false }; // marks the end of the input
+};
+
+enum class Operation
+{
+	sum,
+	quotient,
+};
+
+constexpr std::size_t chunkSize{ 1 << 20 };
+constexpr std::size_t queueCapacity{ 4 }; // per worker, so at most a few MB are in flight
+
+// Parse "x y" lines and write one answer per line (like writeAnswer(), without the words)
+void computeChunk(std::string_view text, Operation op, std::string& out)
+{
+	constexpr std::size_t maxLine{ 24 }; // longest thing one line can produce, including the '\n'
+	constexpr std::string_view badInput{ "bad input\n" };
+	constexpr std::string_view divisionByZero{ "division by zero\n" };
+	constexpr std::string_view overflow{ "overflow\n" };
+
+	// Write through a raw pointer instead of out += ..., growing the string only when it's nearly full
+	out.resize(std::max(out.capacity(), text.size() + maxLine));
+	char* dest{ out.data() };
+	char* destEnd{ out.data() + out.size() - maxLine };
+
+	const char* p{ text.data() };
+	const char* const end{ text.data() + text.size() };
+	while (p < end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+			++p;
+		if (p == end)
+			break;
+
+		if (dest > destEnd)
+		{
+			const std::size_t used{ static_cast<std::size_t>(dest - out.data()) };
+			out.resize(out.size() * 2);
+			dest = out.data() + used;
+			destEnd = out.data() + out.size() - maxLine;
+		}
+
+		long long x{};
+		long long y{};
+		const auto parsedX{ std::from_chars(p, end, x) };
+		p = parsedX.ptr;
+		while (p < end && (*p == ' ' || *p == '\t'))
+			++p;
+		const auto parsedY{ std::from_chars(p, end, y) };
+		p = parsedY.ptr;
+
+		// from_chars reports both "no number here" and "too big for a long long" through ec
+		if (parsedX.ec != std::errc{} || parsedY.ec != std::errc{})
+		{
+			dest = std::copy(badInput.begin(), badInput.end(), dest);
+		}
+		else
+		{
+			const SafeMath::Result<long long> answer{ op == Operation::sum ? SafeMath::add(x, y) : SafeMath::divide(x, y) };
+			if (answer.error == SafeMath::Error::divideByZero)
+			{
+				dest = std::copy(divisionByZero.begin(), divisionByZero.end(), dest);
+			}
+			else if (answer.error == SafeMath::Error::overflow) // a sum past +-9.2e18, or LLONG_MIN / -1
+			{
+				dest = std::copy(overflow.begin(), overflow.end(), dest);
+			}
+			else
+			{
+				dest = std::to_chars(dest, dest + maxLine, answer.value).ptr;
+				*dest++ = '\n';
+			}
+		}
+
+		// Skip anything else on the line
+		while (p < end && *p != '\n')
+			++p;
+	}
+	out.resize(static_cast<std::size_t>(dest - out.data()));
+}
+
+struct PipelineResult
+{
+	double seconds{};
+	StageStats reader{};
+	std::vector<StageStats> workers{};
+	StageStats writer{};
+	bool writeFailed{}; // a short fwrite or a failed fclose, e.g. a full disk
+};
+
+PipelineResult runPipeline(const std::string& inPath, const std::string& outPath, Operation op, std::size_t numWorkers)
+{
+	std::vector<SpscQueue<Chunk, queueCapacity>> toWorkers(numWorkers);
+	std::vector<SpscQueue<Chunk, queueCapacity>> toWriter(numWorkers);
+	PipelineResult result{};
+	result.workers.resize(numWorkers);
+
+	const auto start{ Clock::now() };
+
+	std::thread reader{ [&] {
+		StageStats& stats{ result.reader };
+		std::FILE* in{ std::fopen(inPath.c_str(), "rb") };
+		std::string carry{}; // the unfinished last line of the previous chunk
+		std::size_t next{ 0 };
+		while (in)
+		{
+			const auto busyStart{ Clock::now() };
+			Chunk chunk{};
+			chunk.text = std::move(carry);
+			const std::size_t have{ chunk.text.size() };
+			chunk.text.resize(have + chunkSize);
+			const std::size_t got{ std::fread(chunk.text.data() + have, 1, chunkSize, in) };
+			chunk.text.resize(have + got);
+			if (got == 0)
+			{
+				carry = std::move(chunk.text);
+				break;
+			}
+
+			// Cut after the last newline; the rest goes to the front of the next chunk.
+			// No newline at all means one very long line, so keep reading until it ends
+			// rather than splitting it across two workers.
+			const std::size_t lastNewline{ chunk.text.rfind('\n') };
+			if (lastNewline == std::string::npos)
+			{
+				carry = std::move(chunk.text);
+				stats.busySeconds += std::chrono::duration<double>(Clock::now() - busyStart).count();
+				continue;
+			}
+			carry.assign(chunk.text, lastNewline + 1);
+			chunk.text.resize(lastNewline + 1);
+			stats.busySeconds += std::chrono::duration<double>(Clock::now() - busyStart).count();
+
+			waitFor([&] { return toWorkers[next % numWorkers].tryPush(chunk); }, stats);
+			++next;
+			++stats.items;
+		}
+		if (in)
+			std::fclose(in);
+
+		// A file that doesn't end in a newline still has a last line
+		if (!carry.empty())
+		{
+			Chunk chunk{ std::move(carry) };
+			waitFor([&] { return toWorkers[next % numWorkers].tryPush(chunk); }, stats);
+			++next;
+		}
+		// Tell everyone we're done, in round-robin order so the writer sees it in turn
+		for (std::size_t i{ 0 }; i < numWorkers; ++i)
+		{
+			Chunk done{ {}, true };
+			waitFor([&] { return toWorkers[(next + i) % numWorkers].tryPush(done); }, stats);
+		}
+	} };
+
+	std::vector<std::thread> workers{};
+	for (std::size_t w{ 0 }; w < numWorkers; ++w)
+	{
+		workers.emplace_back([&, w] {
+			StageStats& stats{ result.workers[w] };
+			std::string answers{};
+			while (true)
+			{
+				Chunk chunk{};
+				waitFor([&] { return toWorkers[w].tryPop(chunk); }, stats);
+				if (chunk.last)
+				{
+					waitFor([&] { return toWriter[w].tryPush(chunk); }, stats);
+					break;
+				}
+
+				const auto busyStart{ Clock::now() };
+				computeChunk(chunk.text, op, answers);
+				std::swap(chunk.text, answers); // reuse the input buffer for the next chunk's answers
+				stats.busySeconds += std::chrono::duration<double>(Clock::now() - busyStart).count();
+				++stats.items;
+
+				waitFor([&] { return toWriter[w].tryPush(chunk); }, stats);
+			}
+		});
+	}
+
+	// The writer runs on this thread
+	{
+		StageStats& stats{ result.writer };
+		std::FILE* out{ std::fopen(outPath.c_str(), "wb") };
+		for (std::size_t next{ 0 };; ++next)
+		{
+			Chunk chunk{};
+			waitFor([&] { return toWriter[next % numWorkers].tryPop(chunk); }, stats);
+			if (chunk.last)
+				break;
+
+			const auto busyStart{ Clock::now() };
+			if (out && std::fwrite(chunk.text.data(), 1, chunk.text.size(), out) != chunk.text.size())
+				result.writeFailed = true;
+			stats.busySeconds += std::chrono::duration<double>(Clock::now() - busyStart).count();
+			++stats.items;
+		}
+		if (!out || std::fclose(out) != 0)
+			result.writeFailed = true;
+	}
+
+	reader.join();
+	for (std::thread& worker : workers)
+		worker.join();
+
+	result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return result;
+}
+
+// Everything on one thread, for comparison. Only seconds and writeFailed are filled in.
+PipelineResult runSingleThreaded(const std::string& inPath, const std::string& outPath, Operation op)
+{
+	PipelineResult result{};
+	const auto start{ Clock::now() };
+	std::FILE* in{ std::fopen(inPath.c_str(), "rb") };
+	std::FILE* out{ std::fopen(outPath.c_str(), "wb") };
+	std::string text{};
+	std::string answers{};
+	std::string carry{};
+	while (in && out)
+	{
+		text = carry;
+		const std::size_t have{ text.size() };
+		text.resize(have + chunkSize);
+		const std::size_t got{ std::fread(text.data() + have, 1, chunkSize, in) };
+		text.resize(have + got);
+		if (got == 0)
+			break;
+		const std::size_t lastNewline{ text.rfind('\n') };
+		if (lastNewline == std::string::npos)
+		{
+			carry = text; // a line longer than a chunk, keep reading
+			continue;
+		}
+		carry.assign(text, lastNewline + 1);
+		text.resize(lastNewline + 1);
+		computeChunk(text, op, answers);
+		if (std::fwrite(answers.data(), 1, answers.size(), out) != answers.size())
+			result.writeFailed = true;
+	}
+	if (out && !carry.empty())
+	{
+		computeChunk(carry, op, answers);
+		if (std::fwrite(answers.data(), 1, answers.size(), out) != answers.size())
+			result.writeFailed = true;
+	}
+	if (in)
+		std::fclose(in);
+	if (!out || std::fclose(out) != 0)
+		result.writeFailed = true;
+	result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return result;
+}
+
+void makeSample(const std::string& path, std::size_t bytes)
+{
+	std::FILE* file{ std::fopen(path.c_str(), "wb") };
+	if (!file)
+		return;
+	std::mt19937 mt{ 3 };
+	std::uniform_int_distribution<int> number{ -1'000'000, 1'000'000 };
+	std::string buffer{};
+	for (std::size_t written{ 0 }; written < bytes;)
+	{
+		buffer.clear();
+		for (int i{ 0 }; i < 10000; ++i)
+		{
+			buffer += std::to_string(number(mt));
+			buffer += ' ';
+			buffer += std::to_string(number(mt) / 1000); // some zeros, to exercise "division by zero"
+			buffer += '\n';
+		}
+		std::fwrite(buffer.data(), 1, buffer.size(), file);
+		written += buffer.size();
+	}
+	std::fclose(file);
+}
+
+bool sameContents(const std::string& a, const std::string& b)
+{
+	std::FILE* fa{ std::fopen(a.c_str(), "rb") };
+	std::FILE* fb{ std::fopen(b.c_str(), "rb") };
+	bool same{ fa && fb };
+	std::vector<char> bufA(1 << 20);
+	std::vector<char> bufB(1 << 20);
+	while (same)
+	{
+		const std::size_t gotA{ std::fread(bufA.data(), 1, bufA.size(), fa) };
+		const std::size_t gotB{ std::fread(bufB.data(), 1, bufB.size(), fb) };
+		same = gotA == gotB && std::equal(bufA.begin(), bufA.begin() + static_cast<std::ptrdiff_t>(gotA), bufB.begin());
+		if (gotA == 0)
+			break;
+	}
+	if (fa)
+		std::fclose(fa);
+	if (fb)
+		std::fclose(fb);
+	return same;
+}
+
+void printStage(std::string_view name, const StageStats& stats, double wallSeconds)
+{
+	std::cout << std::setw(12) << name << std::setw(8) << stats.items << " chunks   busy " << std::setw(5)
+	          << static_cast<int>(100.0 * stats.busySeconds / wallSeconds) << "%   waiting " << std::setw(5)
+	          << static_cast<int>(100.0 * stats.waitSeconds / wallSeconds) << "%\n";
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string_view opName{ argc > 1 ? argv[1] : "quotient" };
+	if (opName != "sum" && opName != "quotient")
+	{
+		std::cerr << "Unknown operation '" << opName << "'\n"
+		          << "Usage: pipeline [sum|quotient] [input file] [output file]\n";
+		return 1;
+	}
+	const Operation op{ opName == "sum" ? Operation::sum : Operation::quotient };
+	const std::filesystem::path temp{ std::filesystem::temp_directory_path() };
+	const bool makeInput{ argc <= 2 };
+	const std::string inPath{ makeInput ? (temp / "pipeline_in.txt").string() : argv[2] };
+	const std::string outPath{ argc > 3 ? argv[3] : (temp / "pipeline_out.txt").string() };
+	const std::string checkPath{ (temp / "pipeline_check.txt").string() };
+
+	if (makeInput)
+		makeSample(inPath, 200'000'000);
+
+	// The stages would just see an empty file, so check up front
+	for (const auto& [path, mode] : { std::pair{ &inPath, "rb" }, std::pair{ &outPath, "wb" } })
+	{
+		std::FILE* file{ std::fopen(path->c_str(), mode) };
+		if (!file)
+		{
+			std::cerr << "Can't open " << *path << (mode[0] == 'r' ? " for reading\n" : " for writing\n");
+			return 1;
+		}
+		std::fclose(file);
+	}
+	const double inputBytes{ static_cast<double>(std::filesystem::file_size(inPath)) };
+
+	// Run once to warm the file cache, so both versions read from memory rather than disk
+	runSingleThreaded(inPath, checkPath, op);
+	const PipelineResult single{ runSingleThreaded(inPath, checkPath, op) };
+	if (single.writeFailed)
+	{
+		std::cerr << "Writing " << checkPath << " failed\n";
+		return 1;
+	}
+	std::cout << "single thread: " << inputBytes / single.seconds / 1e9 << " GB/s\n";
+
+	const std::size_t numWorkers{ std::max(1u, std::thread::hardware_concurrency()) };
+	const PipelineResult result{ runPipeline(inPath, outPath, op, numWorkers) };
+	if (result.writeFailed)
+	{
+		std::cerr << "Writing " << outPath << " failed\n";
+		return 1;
+	}
+	std::cout << "pipeline (" << numWorkers << " workers): " << inputBytes / result.seconds / 1e9 << " GB/s, output "
+	          << (sameContents(outPath, checkPath) ? "matches" : "DIFFERS!") << "\n\n";
+
+	printStage("reader", result.reader, result.seconds);
+	for (std::size_t w{ 0 }; w < result.workers.size(); ++w)
+		printStage("worker " + std::to_string(w), result.workers[w], result.seconds);
+	printStage("writer", result.writer, result.seconds);
+
+	std::filesystem::remove(checkPath);
+	if (makeInput)
+	{
+		std::filesystem::remove(inPath);
+		if (argc <= 3)
+			std::filesystem::remove(outPath);
+	}
+	return 0;
+}
@@ -0,0 +1,329 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip> // for std::setprecision
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility> // for std::move
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TRACE_HAS_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h> // for __rdtsc
+#else
+#include <x86intrin.h> // for __rdtsc
+#endif
+#endif
+
+#ifndef _WIN32
+#include <time.h> // for clock_gettime
+#endif
+
+// The debugging exercises in this chapter (debug1.cpp, quiz_q3.cpp's a() -> b() -> c() -> d())
+// find out what a program does by stepping through it or printing. That tells you the order calls
+// happen in, but not where the time goes. This records it instead:
+//
+//     void b()
+//     {
+//         TRACE_FUNCTION();        // or TRACE_SCOPE("any name") for part of a function
+//         c();
+//         d();
+//     }
+//     ...
+//     Trace::saveChromeJson("trace.json");
+//
+// Open trace.json in https://ui.perfetto.dev (or chrome://tracing) to see every call as a bar on a
+// timeline, nested under its caller, one row per thread.
+//
+// Recording has to be cheap enough to leave in hot code, so a scope only reads a clock when it
+// starts and ends, and appends {name, start, end} to a buffer owned by its own thread: no lock,
+// no allocation (except a new 16K-event chunk now and then), no formatting. The work of turning
+// that into JSON happens once, at the end.
+//
+// The clock is the CPU's time stamp counter (rdtsc) on x86, which is much cheaper to read than the
+// OS clock; its ticks are converted to microseconds only when exporting. Modern x86 CPUs tick it at
+// a constant rate whatever the clock speed. Define TRACE_USE_CLOCK_GETTIME to use the OS's monotonic
+// clock instead (always the case on other CPUs), and TRACE_DISABLED to compile all scopes away.
+// Requires C++17 or newer.
+namespace Trace
+{
+	// ---- Timestamps ----
+
+#if defined(TRACE_HAS_TSC) && !defined(TRACE_USE_CLOCK_GETTIME)
+	constexpr bool usesTsc{ true };
+#else
+	constexpr bool usesTsc{ false };
+#endif
+
+	inline std::uint64_t readMonotonicNs()
+	{
+#ifdef _WIN32
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+		timespec ts{};
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<std::uint64_t>(ts.tv_nsec);
+#endif
+	}
+
+	inline std::uint64_t now()
+	{
+#ifdef TRACE_HAS_TSC
+		if constexpr (usesTsc)
+			return __rdtsc();
+#endif
+		return readMonotonicNs();
+	}
+
+	// How many now() ticks make a microsecond. For the TSC this is measured once, against the OS clock.
+	inline double ticksPerMicrosecond()
+	{
+		static const double ticks{ [] {
+			if (!usesTsc)
+				return 1000.0;
+			const std::uint64_t startNs{ readMonotonicNs() };
+			const std::uint64_t startTicks{ now() };
+			std::uint64_t elapsedNs{ 0 };
+			while (elapsedNs < 20'000'000) // 20 ms is plenty for 5 good digits
+				elapsedNs = readMonotonicNs() - startNs;
+			return static_cast<double>(now() - startTicks) * 1000.0 / static_cast<double>(elapsedNs);
+		}() };
+		return ticks;
+	}
+
+	// ---- Per-thread event buffers ----
+
+	struct Event
+	{
+		const char* name{}; // must live until the export: a string literal or __func__
+		std::uint64_t start{};
+		std::uint64_t end{};
+	};
+
+	// Events are stored in fixed-size chunks, so a full buffer gets a new chunk instead of
+	// copying everything recorded so far (which would show up as a spike in the trace)
+	class ThreadBuffer
+	{
+	public:
+		static constexpr std::size_t chunkSize{ 16 * 1024 };
+
+		explicit ThreadBuffer(std::uint32_t threadId)
+			: m_threadId{ threadId }, m_threadName{ "thread " + std::to_string(threadId) }
+		{
+		}
+
+		void record(const char* name, std::uint64_t start, std::uint64_t end)
+		{
+			if (m_used == chunkSize || m_chunks.empty())
+			{
+				m_chunks.push_back(std::make_unique<Event[]>(chunkSize));
+				m_used = 0;
+			}
+			m_chunks.back()[m_used++] = { name, start, end };
+		}
+
+		template <typename Fn>
+		void forEach(Fn fn) const
+		{
+			for (std::size_t c{ 0 }; c < m_chunks.size(); ++c)
+			{
+				const std::size_t count{ c + 1 == m_chunks.size() ? m_used : chunkSize };
+				for (std::size_t i{ 0 }; i < count; ++i)
+					fn(m_chunks[c][i]);
+			}
+		}
+
+		std::size_t size() const { return m_chunks.empty() ? 0 : (m_chunks.size() - 1) * chunkSize + m_used; }
+
+		void clear()
+		{
+			m_chunks.clear();
+			m_used = 0;
+		}
+
+		std::uint32_t threadId() const { return m_threadId; }
+		const std::string& threadName() const { return m_threadName; }
+		void setThreadName(std::string name) { m_threadName = std::move(name); }
+
+	private:
+		std::vector<std::unique_ptr<Event[]>> m_chunks{};
+		std::size_t m_used{ 0 };
+		std::uint32_t m_threadId{};
+		std::string m_threadName{};
+	};
+
+	// Owns every thread's buffer, so the events outlive the threads that recorded them.
+	// The mutex is only taken when a thread records its first event, and by the functions below.
+	struct Registry
+	{
+		std::mutex mutex{};
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers{};
+		std::atomic<bool> enabled{ true };
+		std::uint64_t startTicks{ now() }; // timestamps in the export count from here
+	};
+
+	inline Registry& registry()
+	{
+		static Registry r{};
+		return r;
+	}
+
+	inline ThreadBuffer& threadBuffer()
+	{
+		thread_local ThreadBuffer* buffer{ [] {
+			Registry& r{ registry() };
+			std::lock_guard lock{ r.mutex };
+			r.buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(r.buffers.size() + 1)));
+			return r.buffers.back().get();
+		}() };
+		return *buffer;
+	}
+
+	// ---- Recording ----
+
+	inline void setEnabled(bool enabled) { registry().enabled.store(enabled, std::memory_order_relaxed); }
+	inline bool enabled() { return registry().enabled.load(std::memory_order_relaxed); }
+
+	// Shown as the row title in the trace viewer
+	inline void setThreadName(std::string name) { threadBuffer().setThreadName(std::move(name)); }
+
+	// Times from construction to destruction. Use the macros below rather than naming one yourself.
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name)
+			: m_name{ name }, m_start{ enabled() ? now() : 0 }
+		{
+		}
+
+		~Scope()
+		{
+			if (m_start != 0)
+				threadBuffer().record(m_name, m_start, now());
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		const char* m_name{};
+		std::uint64_t m_start{}; // 0 if tracing was off when the scope began
+	};
+
+	// ---- Reading the events back ----
+	// Only call these while no other thread is recording (e.g. after joining the workers).
+
+	// Calls fn(buffer, event) for every event of every thread
+	template <typename Fn>
+	void forEachEvent(Fn fn)
+	{
+		Registry& r{ registry() };
+		std::lock_guard lock{ r.mutex };
+		for (const std::unique_ptr<ThreadBuffer>& buffer : r.buffers)
+			buffer->forEach([&](const Event& e) { fn(*buffer, e); });
+	}
+
+	inline std::size_t eventCount()
+	{
+		std::size_t count{ 0 };
+		forEachEvent([&](const ThreadBuffer&, const Event&) { ++count; });
+		return count;
+	}
+
+	// Throws all events away (the threads and their names are kept)
+	inline void clear()
+	{
+		Registry& r{ registry() };
+		std::lock_guard lock{ r.mutex };
+		for (const std::unique_ptr<ThreadBuffer>& buffer : r.buffers)
+			buffer->clear();
+	}
+
+	inline void writeJsonString(std::ostream& out, const std::string& text)
+	{
+		out << '"';
+		for (char ch : text)
+		{
+			if (ch == '"' || ch == '\\')
+				out << '\\' << ch;
+			else if (static_cast<unsigned char>(ch) < 0x20)
+				out << ' ';
+			else
+				out << ch;
+		}
+		out << '"';
+	}
+
+	// The Chrome trace event format: one "complete" event (ph "X") per scope with its start and
+	// duration in microseconds, plus one "thread_name" metadata event per thread
+	inline void writeChromeJson(std::ostream& out)
+	{
+		const double ticksPerUs{ ticksPerMicrosecond() };
+		const std::uint64_t base{ registry().startTicks };
+		const auto oldFlags{ out.flags() };
+		const auto oldPrecision{ out.precision() };
+		out << std::fixed << std::setprecision(3);
+
+		out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+		bool first{ true };
+		auto separator = [&] {
+			if (!first)
+				out << ",\n";
+			first = false;
+		};
+
+		{
+			Registry& r{ registry() };
+			std::lock_guard lock{ r.mutex };
+			for (const std::unique_ptr<ThreadBuffer>& buffer : r.buffers)
+			{
+				separator();
+				out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->threadId() << ",\"args\":{\"name\":";
+				writeJsonString(out, buffer->threadName());
+				out << "}}";
+			}
+		}
+
+		forEachEvent([&](const ThreadBuffer& buffer, const Event& e) {
+			separator();
+			out << "{\"ph\":\"X\",\"name\":";
+			writeJsonString(out, e.name);
+			out << ",\"pid\":1,\"tid\":" << buffer.threadId()
+				<< ",\"ts\":" << static_cast<double>(e.start - base) / ticksPerUs
+				<< ",\"dur\":" << static_cast<double>(e.end - e.start) / ticksPerUs << '}';
+		});
+		out << "\n]}\n";
+
+		out.flags(oldFlags);
+		out.precision(oldPrecision);
+	}
+
+	inline bool saveChromeJson(const std::string& path)
+	{
+		std::ofstream file{ path };
+		if (!file)
+			return false;
+		writeChromeJson(file);
+		return static_cast<bool>(file);
+	}
+}
+
+#ifdef TRACE_DISABLED
+#define TRACE_SCOPE(name)
+#else
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::Trace::Scope TRACE_CONCAT(traceScope, __LINE__){ name }
+#endif
+#define TRACE_FUNCTION() TRACE_SCOPE(__func__)
+
+#endif // TRACE_H
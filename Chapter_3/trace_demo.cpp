@@ -0,0 +1,166 @@
+// quiz_q3.cpp's a() -> b() -> c() -> d() chain, with something to do in each function and a
+// TRACE_FUNCTION() at the top of each one. Run it, then open trace.json in https://ui.perfetto.dev
+// to see each call nested under its caller, for every thread.
+//
+// It also measures what tracing costs: reading each clock, and a whole scope (start + end + record).
+//
+// Build with -O2 -pthread. Add -DTRACE_USE_CLOCK_GETTIME to compare against the OS clock,
+// or -DTRACE_DISABLED to compile the scopes away.
+
+#include <algorithm> // for std::sort
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional> // for std::ref
+#include <iomanip> // for std::setw
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "trace.h"
+
+double g_sink{ 0.0 }; // results go here so the compiler can't skip the work
+
+// Some arithmetic
+double c(int n)
+{
+	TRACE_FUNCTION();
+	double total{ 0.0 };
+	for (int i{ 1 }; i <= n; ++i)
+		total += std::sqrt(static_cast<double>(i));
+	return total;
+}
+
+// Some memory traffic
+double d(std::vector<int>& values)
+{
+	TRACE_FUNCTION();
+	std::sort(values.begin(), values.end());
+	return values[values.size() / 2];
+}
+
+double b(std::mt19937& mt)
+{
+	TRACE_FUNCTION();
+	std::vector<int> values(2000 + mt() % 2000);
+	{
+		TRACE_SCOPE("b: fill");
+		for (int& v : values)
+			v = static_cast<int>(mt());
+	}
+	return c(5000) + d(values);
+}
+
+double a(std::mt19937& mt)
+{
+	TRACE_FUNCTION();
+	double total{ 0.0 };
+	for (int i{ 0 }; i < 3; ++i)
+		total += b(mt);
+	return total;
+}
+
+void worker(int id, int calls, double& result)
+{
+	Trace::setThreadName("worker " + std::to_string(id));
+	std::mt19937 mt{ static_cast<std::mt19937::result_type>(id) };
+	double total{ 0.0 };
+	for (int i{ 0 }; i < calls; ++i)
+		total += a(mt);
+	result = total;
+}
+
+template <typename Fn>
+double nanosecondsPerCall(int calls, Fn fn)
+{
+	const auto start{ std::chrono::steady_clock::now() };
+	for (int i{ 0 }; i < calls; ++i)
+		fn();
+	const std::chrono::duration<double, std::nano> elapsed{ std::chrono::steady_clock::now() - start };
+	return elapsed.count() / calls;
+}
+
+void measureOverhead()
+{
+	constexpr int calls{ 2'000'000 };
+	std::uint64_t sum{ 0 };
+	const double emptyLoop{ nanosecondsPerCall(calls, [&] { sum += 1; }) };
+	std::cout << "Cost of tracing (" << (Trace::usesTsc ? "rdtsc" : "clock_gettime") << " build, "
+			  << Trace::ticksPerMicrosecond() << " ticks per microsecond):\n";
+#ifdef TRACE_HAS_TSC
+	std::cout << "  read rdtsc:          " << nanosecondsPerCall(calls, [&] { sum += __rdtsc(); }) - emptyLoop << " ns\n";
+#endif
+	std::cout << "  read clock_gettime:  " << nanosecondsPerCall(calls, [&] { sum += Trace::readMonotonicNs(); }) - emptyLoop << " ns\n";
+	std::cout << "  read steady_clock:   "
+			  << nanosecondsPerCall(calls, [&] { sum += static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()); }) - emptyLoop << " ns\n";
+
+	std::cout << "  scope, recording:    " << nanosecondsPerCall(calls, [&] { TRACE_SCOPE("overhead"); sum += 1; }) - emptyLoop << " ns\n";
+	Trace::setEnabled(false);
+	std::cout << "  scope, tracing off:  " << nanosecondsPerCall(calls, [&] { TRACE_SCOPE("overhead"); sum += 1; }) - emptyLoop << " ns\n";
+	Trace::setEnabled(true);
+
+	Trace::clear(); // don't put two million "overhead" events in the trace
+	g_sink += static_cast<double>(sum % 2);
+}
+
+int main()
+{
+	measureOverhead();
+
+	Trace::setThreadName("main");
+	const int threads{ 3 };
+	std::vector<std::thread> workers{};
+	std::vector<double> results(threads);
+	{
+		TRACE_SCOPE("main: run workers");
+		for (int id{ 1 }; id <= threads; ++id)
+			workers.emplace_back(worker, id, 100, std::ref(results[static_cast<std::size_t>(id - 1)]));
+		std::mt19937 mt{ 0 };
+		g_sink += a(mt);
+		for (std::thread& t : workers)
+			t.join();
+	}
+	for (double r : results)
+		g_sink += r;
+
+	// Where did the time go? Total and average per function, over all threads
+	struct Totals
+	{
+		std::uint64_t calls{};
+		std::uint64_t ticks{};
+	};
+	std::map<std::string, Totals> totals{};
+	Trace::forEachEvent([&](const Trace::ThreadBuffer&, const Trace::Event& e) {
+		Totals& t{ totals[e.name] };
+		++t.calls;
+		t.ticks += e.end - e.start;
+	});
+
+	std::cout << "\nRecorded " << Trace::eventCount() << " events:\n";
+	for (const auto& [name, t] : totals)
+	{
+		const double totalUs{ static_cast<double>(t.ticks) / Trace::ticksPerMicrosecond() };
+		std::cout << "  " << std::setw(20) << std::left << name << std::setw(8) << std::right << t.calls << " calls, "
+				  << std::setw(10) << totalUs / 1000 << " ms total, " << std::setw(8) << totalUs / static_cast<double>(t.calls) << " us each\n";
+	}
+
+	if (Trace::saveChromeJson("trace.json"))
+		std::cout << "\nWrote trace.json (open it in https://ui.perfetto.dev)\n";
+	else
+		std::cout << "\nCouldn't write trace.json\n";
+
+	std::cout << "(" << static_cast<long long>(g_sink) % 10 << ")\n";
+	return 0;
+}
+
+/* Sample results (one core in a VM, where rdtsc is slower than on bare metal):
+Cost of tracing (rdtsc build, 2100 ticks per microsecond):
+  read rdtsc:          18.4 ns
+  read clock_gettime:  31.6 ns
+  read steady_clock:   34.2 ns
+  scope, recording:    54.8 ns
+  scope, tracing off:  1.1 ns
+With -DTRACE_USE_CLOCK_GETTIME a recorded scope costs 84 ns.
+*/
@@ -0,0 +1,103 @@
+// Build: g++ -std=c++17 -O3 -mavx2 checked_math.cpp
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+#include "checked_math.h"
+
+std::string_view errorName(SafeMath::Error error)
+{
+    switch (error)
+    {
+    case SafeMath::Error::none:         return "ok";
+    case SafeMath::Error::overflow:     return "overflow";
+    case SafeMath::Error::divideByZero: return "divide by zero";
+    default:                            return "???";
+    }
+}
+
+// calculate() from Chapter_8/calculate_switch.cpp, but it reports overflow and division by zero
+// instead of invoking undefined behavior
+SafeMath::Result<int> calculate(int x, int y, char op)
+{
+    switch (op)
+    {
+    case '+':
+        return SafeMath::add(x, y);
+    case '-':
+        return SafeMath::subtract(x, y);
+    case '*':
+        return SafeMath::multiply(x, y);
+    case '/':
+        return SafeMath::divide(x, y);
+    case '%':
+        return SafeMath::remainder(x, y);
+    default:
+        std::cout << "calculate(): Unhandled case\n";
+        return {};
+    }
+}
+
+void printCalculation(int x, char op, int y)
+{
+    const SafeMath::Result<int> result{ calculate(x, y, op) };
+    std::cout << x << ' ' << op << ' ' << y << " is ";
+    if (result.ok())
+        std::cout << result.value << '\n';
+    else
+        std::cout << errorName(result.error) << '\n';
+}
+
+int main()
+{
+    // assume 4 byte integers
+    constexpr int x{ 2'147'483'647 };
+    printCalculation(x, '+', 1);
+    printCalculation(x, '-', 1);
+    printCalculation(-2'147'483'647 - 1, '/', -1);
+    printCalculation(7, '%', 0);
+    printCalculation(46'341, '*', 46'341);
+
+    std::cout << "saturating: " << SafeMath::saturatingAdd(x, 1) << '\n';   // 2147483647
+    std::cout << "wrapping:   " << SafeMath::wrappingAdd(x, 1) << "\n\n";   // -2147483648, but without UB
+
+    // Benchmark: checked batch add vs plain (wrapping) add over big arrays
+    constexpr std::size_t n{ 1 << 22 };
+    std::mt19937 mt{ 7 };
+    std::vector<std::int32_t> a(n);
+    std::vector<std::int32_t> b(n);
+    for (std::size_t i{ 0 }; i < n; ++i)
+    {
+        a[i] = static_cast<std::int32_t>(mt());
+        b[i] = static_cast<std::int32_t>(mt() >> 4); // some of these sums overflow, most don't
+    }
+    std::vector<std::int32_t> out(n);
+    std::vector<std::uint8_t> mask(n);
+
+    constexpr int repeats{ 20 };
+    std::size_t overflows{ 0 };
+
+    const auto uncheckedStart{ std::chrono::steady_clock::now() };
+    for (int r{ 0 }; r < repeats; ++r)
+    {
+        for (std::size_t i{ 0 }; i < n; ++i)
+            out[i] = SafeMath::wrappingAdd(a[i], b[i]);
+    }
+    const std::chrono::duration<double> unchecked{ std::chrono::steady_clock::now() - uncheckedStart };
+    const std::int32_t uncheckedSample{ out[n / 2] };
+
+    const auto checkedStart{ std::chrono::steady_clock::now() };
+    for (int r{ 0 }; r < repeats; ++r)
+        overflows = SafeMath::addBatch(a.data(), b.data(), out.data(), mask.data(), n);
+    const std::chrono::duration<double> checked{ std::chrono::steady_clock::now() - checkedStart };
+
+    std::cout << overflows << " of " << n << " sums overflowed (sample " << uncheckedSample << ", " << out[n / 2] << ")\n";
+    std::cout << "unchecked add: " << unchecked.count() * 1e3 / repeats << " ms per pass\n";
+    std::cout << "checked add:   " << checked.count() * 1e3 / repeats << " ms per pass ("
+              << (checked.count() / unchecked.count() - 1.0) * 100.0 << "% overhead)\n";
+
+    return 0;
+}
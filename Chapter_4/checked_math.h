@@ -0,0 +1,257 @@
+#ifndef CHECKED_MATH_H
+#define CHECKED_MATH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// IntegerOverflow.cpp shows that x + 1 at 2'147'483'647 is undefined behavior for a signed int.
+// This header gives three ways to do integer math without that hole:
+//  - checked:    returns a Result that says if the math overflowed (or divided by zero)
+//  - saturating: clamps to the min/max of the type instead of overflowing
+//  - wrapping:   wraps around on purpose, like unsigned math (well defined, no UB)
+// plus batch versions for whole arrays that also fill in a per-element overflow mask.
+//
+// The checked versions use the GCC/Clang builtins (__builtin_add_overflow etc.), which compile
+// to a plain add followed by a jump-on-overflow flag check, so they are nearly free.
+// Requires C++17 or newer.
+namespace SafeMath
+{
+	enum class Error
+	{
+		none,
+		overflow,
+		divideByZero,
+	};
+
+	template <typename T>
+	struct Result
+	{
+		T value{};
+		Error error{ Error::none };
+
+		bool ok() const { return error == Error::none; }
+	};
+
+	// ---- Checked ----
+
+	template <typename T>
+	constexpr Result<T> add(T x, T y)
+	{
+		static_assert(std::is_integral_v<T>, "SafeMath only works on integer types");
+		T result{};
+#if defined(__GNUC__) || defined(__clang__)
+		const bool overflow{ __builtin_add_overflow(x, y, &result) };
+#else
+		const bool overflow{ (y > 0 && x > std::numeric_limits<T>::max() - y) || (y < 0 && x < std::numeric_limits<T>::min() - y) };
+		if (!overflow)
+			result = static_cast<T>(x + y);
+#endif
+		return { result, overflow ? Error::overflow : Error::none };
+	}
+
+	template <typename T>
+	constexpr Result<T> subtract(T x, T y)
+	{
+		static_assert(std::is_integral_v<T>, "SafeMath only works on integer types");
+		T result{};
+#if defined(__GNUC__) || defined(__clang__)
+		const bool overflow{ __builtin_sub_overflow(x, y, &result) };
+#else
+		const bool overflow{ (y < 0 && x > std::numeric_limits<T>::max() + y) || (y > 0 && x < std::numeric_limits<T>::min() + y) };
+		if (!overflow)
+			result = static_cast<T>(x - y);
+#endif
+		return { result, overflow ? Error::overflow : Error::none };
+	}
+
+	template <typename T>
+	constexpr Result<T> multiply(T x, T y)
+	{
+		static_assert(std::is_integral_v<T>, "SafeMath only works on integer types");
+		T result{};
+#if defined(__GNUC__) || defined(__clang__)
+		const bool overflow{ __builtin_mul_overflow(x, y, &result) };
+#else
+		bool overflow{ false };
+		if (x != 0 && y != 0)
+		{
+			if constexpr (std::is_signed_v<T>)
+				overflow = (x == -1 && y == std::numeric_limits<T>::min()) || (y == -1 && x == std::numeric_limits<T>::min())
+					|| (x != -1 && y != -1 && static_cast<T>(x * y) / y != x);
+			else
+				overflow = x > std::numeric_limits<T>::max() / y;
+		}
+		if (!overflow)
+			result = static_cast<T>(x * y);
+#endif
+		return { result, overflow ? Error::overflow : Error::none };
+	}
+
+	// Division can only overflow in one case: min / -1 (the answer is one past max)
+	template <typename T>
+	constexpr bool divisionOverflows(T x, T y)
+	{
+		if constexpr (std::is_signed_v<T>)
+			return x == std::numeric_limits<T>::min() && y == -1;
+		else
+			return false;
+	}
+
+	template <typename T>
+	constexpr Result<T> divide(T x, T y)
+	{
+		if (y == 0)
+			return { 0, Error::divideByZero };
+		if (divisionOverflows(x, y))
+			return { 0, Error::overflow };
+		return { static_cast<T>(x / y), Error::none };
+	}
+
+	template <typename T>
+	constexpr Result<T> remainder(T x, T y)
+	{
+		if (y == 0)
+			return { 0, Error::divideByZero };
+		if (divisionOverflows(x, y))
+			return { 0, Error::none }; // min % -1 is mathematically 0, but computing it would trap on x86
+		return { static_cast<T>(x % y), Error::none };
+	}
+
+	// ---- Saturating ----
+
+	// The value to clamp to when x op y overflowed: it can only overflow towards the sign of the true answer
+	template <typename T>
+	constexpr T saturate(bool towardsMax)
+	{
+		return towardsMax ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+	}
+
+	template <typename T>
+	constexpr T saturatingAdd(T x, T y)
+	{
+		const Result<T> r{ add(x, y) };
+		return r.ok() ? r.value : saturate<T>(y > 0);
+	}
+
+	template <typename T>
+	constexpr T saturatingSubtract(T x, T y)
+	{
+		const Result<T> r{ subtract(x, y) };
+		if constexpr (std::is_signed_v<T>)
+			return r.ok() ? r.value : saturate<T>(y < 0);
+		else
+			return r.ok() ? r.value : T{ 0 };
+	}
+
+	template <typename T>
+	constexpr T saturatingMultiply(T x, T y)
+	{
+		const Result<T> r{ multiply(x, y) };
+		return r.ok() ? r.value : saturate<T>((x < 0) == (y < 0));
+	}
+
+	// y must not be 0
+	template <typename T>
+	constexpr T saturatingDivide(T x, T y)
+	{
+		return divisionOverflows(x, y) ? std::numeric_limits<T>::max() : static_cast<T>(x / y);
+	}
+
+	// ---- Wrapping ----
+	// Do the math in the unsigned type, where wrapping around is well defined, then convert back.
+
+	template <typename T>
+	constexpr T wrappingAdd(T x, T y)
+	{
+		using U = std::make_unsigned_t<T>;
+		return static_cast<T>(static_cast<U>(static_cast<U>(x) + static_cast<U>(y)));
+	}
+
+	template <typename T>
+	constexpr T wrappingSubtract(T x, T y)
+	{
+		using U = std::make_unsigned_t<T>;
+		return static_cast<T>(static_cast<U>(static_cast<U>(x) - static_cast<U>(y)));
+	}
+
+	template <typename T>
+	constexpr T wrappingMultiply(T x, T y)
+	{
+		using U = std::make_unsigned_t<T>;
+		return static_cast<T>(static_cast<U>(static_cast<U>(x) * static_cast<U>(y)));
+	}
+
+	// ---- Batch (whole arrays) ----
+	// out[i] = a[i] op b[i], and mask[i] = 1 if that element overflowed (out[i] then holds the wrapped value).
+	// Returns how many elements overflowed.
+	// The loops are written without branches (the overflow test is a few bit operations on the
+	// wrapped result), so the compiler turns them into SIMD code: 8 int32 lanes per step with AVX2.
+	// Build with -O3 (GCC's -O2 only vectorizes loops whose trip count it knows up front).
+
+	template <typename T>
+	std::size_t addBatch(const T* a, const T* b, T* out, std::uint8_t* mask, std::size_t n)
+	{
+		static_assert(std::is_signed_v<T>, "batch functions are for signed types");
+		std::size_t overflows{ 0 };
+		for (std::size_t i{ 0 }; i < n; ++i)
+		{
+			const T sum{ wrappingAdd(a[i], b[i]) };
+			// Overflow happened if a and b have the same sign and the sum's sign differs from both
+			const bool overflow{ ((a[i] ^ sum) & (b[i] ^ sum)) < 0 };
+			out[i] = sum;
+			mask[i] = overflow;
+			overflows += overflow;
+		}
+		return overflows;
+	}
+
+	template <typename T>
+	std::size_t subtractBatch(const T* a, const T* b, T* out, std::uint8_t* mask, std::size_t n)
+	{
+		static_assert(std::is_signed_v<T>, "batch functions are for signed types");
+		std::size_t overflows{ 0 };
+		for (std::size_t i{ 0 }; i < n; ++i)
+		{
+			const T diff{ wrappingSubtract(a[i], b[i]) };
+			// Overflow happened if a and b have different signs and the result's sign differs from a
+			const bool overflow{ ((a[i] ^ b[i]) & (a[i] ^ diff)) < 0 };
+			out[i] = diff;
+			mask[i] = overflow;
+			overflows += overflow;
+		}
+		return overflows;
+	}
+
+	// int32 only: multiply in 64 bits, then check the result fits back in 32
+	inline std::size_t multiplyBatch(const std::int32_t* a, const std::int32_t* b, std::int32_t* out, std::uint8_t* mask, std::size_t n)
+	{
+		std::size_t overflows{ 0 };
+		for (std::size_t i{ 0 }; i < n; ++i)
+		{
+			const std::int64_t wide{ static_cast<std::int64_t>(a[i]) * b[i] };
+			const bool overflow{ wide != static_cast<std::int32_t>(wide) };
+			out[i] = static_cast<std::int32_t>(wide);
+			mask[i] = overflow;
+			overflows += overflow;
+		}
+		return overflows;
+	}
+
+	template <typename T>
+	void saturatingAddBatch(const T* a, const T* b, T* out, std::size_t n)
+	{
+		static_assert(std::is_signed_v<T>, "batch functions are for signed types");
+		for (std::size_t i{ 0 }; i < n; ++i)
+		{
+			const T sum{ wrappingAdd(a[i], b[i]) };
+			const bool overflow{ ((a[i] ^ sum) & (b[i] ^ sum)) < 0 };
+			// On overflow the answer has a's sign: max if a >= 0, min if a < 0
+			const T clamped{ a[i] < 0 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max() };
+			out[i] = overflow ? clamped : sum;
+		}
+	}
+}
+
+#endif // CHECKED_MATH_H
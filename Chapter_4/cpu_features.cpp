@@ -0,0 +1,131 @@
+// Like sizeOf.cpp, but for things only the running CPU knows.
+// Also shows CpuFeatures::select(): the same "sum an array" kernel written for each tier,
+// with the best one picked once at startup.
+//
+// Try: LEARNCPP_SIMD=scalar ./cpu_features
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip> // for std::setw
+#include <iostream>
+#include <numeric> // for std::iota
+#include <vector>
+#include <immintrin.h>
+#include "cpu_features.h"
+
+using SumFn = std::int64_t (*)(const std::int32_t* data, std::size_t n);
+
+std::int64_t sumScalar(const std::int32_t* data, std::size_t n)
+{
+    std::int64_t total{ 0 };
+    for (std::size_t i{ 0 }; i < n; ++i)
+        total += data[i];
+    return total;
+}
+
+// SSE4.1/4.2: widen 2 ints at a time to 64 bits and add
+CPU_TARGET_SSE42 std::int64_t sumSse42(const std::int32_t* data, std::size_t n)
+{
+    __m128i total{ _mm_setzero_si128() };
+    std::size_t i{ 0 };
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128i x{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)) };
+        total = _mm_add_epi64(total, _mm_cvtepi32_epi64(x));
+        total = _mm_add_epi64(total, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+    }
+    std::int64_t lanes[2]{};
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+    return lanes[0] + lanes[1] + sumScalar(data + i, n - i);
+}
+
+CPU_TARGET_AVX2 std::int64_t sumAvx2(const std::int32_t* data, std::size_t n)
+{
+    __m256i total{ _mm256_setzero_si256() };
+    std::size_t i{ 0 };
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)) };
+        total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    std::int64_t lanes[4]{};
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumScalar(data + i, n - i);
+}
+
+CPU_TARGET_AVX512 std::int64_t sumAvx512(const std::int32_t* data, std::size_t n)
+{
+    __m512i total{ _mm512_setzero_si512() };
+    std::size_t i{ 0 };
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m512i x{ _mm512_loadu_si512(data + i) };
+        total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(x)));
+        total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(x, 1)));
+    }
+    return _mm512_reduce_add_epi64(total) + sumScalar(data + i, n - i);
+}
+
+constexpr CpuFeatures::Implementations<SumFn> sumImpls{ sumScalar, sumSse42, sumAvx2, sumAvx512 };
+
+// Bound once, the first time sum() is called; every call after that goes straight to the chosen version
+std::int64_t sum(const std::int32_t* data, std::size_t n)
+{
+    static const SumFn impl{ CpuFeatures::select(sumImpls) };
+    return impl(data, n);
+}
+
+void printSize(const char* name, std::size_t bytes)
+{
+    std::cout << std::setw(16) << name;
+    if (bytes == 0)
+        std::cout << "unknown\n";
+    else
+        std::cout << bytes / 1024 << " KiB\n";
+}
+
+int main()
+{
+    const CpuFeatures::Features& f{ CpuFeatures::features() };
+
+    std::cout << std::left << std::boolalpha; // left justify output, print bools as true or false
+
+    std::cout << std::setw(16) << "SSE4.2:" << f.sse42 << '\n';
+    std::cout << std::setw(16) << "AVX2:" << f.avx2 << '\n';
+    std::cout << std::setw(16) << "AVX-512F:" << f.avx512f << '\n';
+    std::cout << std::setw(16) << "AVX-512BW:" << f.avx512bw << '\n';
+    std::cout << std::setw(16) << "BMI2:" << f.bmi2 << '\n';
+    printSize("L1 data cache:", f.l1Cache);
+    printSize("L2 cache:", f.l2Cache);
+    printSize("L3 cache:", f.l3Cache);
+    std::cout << std::setw(16) << "cache line:" << f.cacheLine << " bytes\n\n";
+
+    std::cout << std::setw(16) << "hardware tier:" << CpuFeatures::tierName(CpuFeatures::hardwareTier()) << '\n';
+    std::cout << std::setw(16) << "active tier:" << CpuFeatures::tierName(CpuFeatures::activeTier()) << '\n';
+    std::cout << std::setw(16) << "sum() uses:" << CpuFeatures::tierName(CpuFeatures::selectedTier(sumImpls)) << "\n\n";
+
+    // Every implementation the CPU can run should give the same answer
+    std::vector<std::int32_t> data(1 << 24);
+    std::iota(data.begin(), data.end(), -(1 << 23));
+
+    for (CpuFeatures::Tier tier : { CpuFeatures::Tier::scalar, CpuFeatures::Tier::sse42, CpuFeatures::Tier::avx2, CpuFeatures::Tier::avx512 })
+    {
+        if (tier > CpuFeatures::activeTier())
+            break;
+
+        const SumFn impl{ tier == CpuFeatures::Tier::scalar ? sumImpls.scalar
+                          : tier == CpuFeatures::Tier::sse42 ? sumImpls.sse42
+                          : tier == CpuFeatures::Tier::avx2  ? sumImpls.avx2
+                                                             : sumImpls.avx512 };
+        const auto start{ std::chrono::steady_clock::now() };
+        const std::int64_t total{ impl(data.data(), data.size()) };
+        const std::chrono::duration<double> seconds{ std::chrono::steady_clock::now() - start };
+
+        std::cout << std::setw(16) << CpuFeatures::tierName(tier) << total << "  (" << data.size() * 4 / seconds.count() / 1e9 << " GB/s)\n";
+    }
+
+    std::cout << std::setw(16) << "sum():" << sum(data.data(), data.size()) << '\n';
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <cstddef>
+#include <cstdlib> // for std::getenv
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // otherwise windows.h defines min and max macros that break std::min/std::max
+#endif
+#include <windows.h>
+#endif
+
+// sizeOf.cpp prints facts the compiler knows. This header asks the CPU at runtime:
+// which SIMD instruction sets it has (SSE4.2, AVX2, AVX-512, BMI2) and how big its caches are.
+//
+// It also has a tiny dispatch helper: you write a kernel several times (scalar, AVX2, ...),
+// and CpuFeatures::select() picks the best one the CPU supports, once. After that every call
+// is a plain function pointer call, so one binary runs well on old and new machines alike.
+//
+// Set the environment variable LEARNCPP_SIMD to scalar, sse42, avx2 or avx512 to force a lower
+// tier for testing (asking for a higher tier than the CPU has is ignored, since it would crash).
+// Requires C++17 or newer.
+
+// Put one of these in front of a function to compile just that function for a newer CPU.
+// Only call such a function after checking the CPU supports it!
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define CPU_TARGET_AVX2 __attribute__((target("avx2,bmi2")))
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,bmi2")))
+#else
+// MSVC lets you use any intrinsic in any function, so nothing is needed
+#define CPU_TARGET_SSE42
+#define CPU_TARGET_AVX2
+#define CPU_TARGET_AVX512
+#endif
+
+namespace CpuFeatures
+{
+	enum class Tier
+	{
+		scalar,
+		sse42,
+		avx2,
+		avx512,
+	};
+
+	constexpr std::string_view tierName(Tier tier)
+	{
+		switch (tier)
+		{
+		case Tier::scalar: return "scalar";
+		case Tier::sse42:  return "sse4.2";
+		case Tier::avx2:   return "avx2";
+		case Tier::avx512: return "avx512";
+		default:           return "???";
+		}
+	}
+
+	struct Features
+	{
+		bool sse42{ false };
+		bool avx2{ false };
+		bool avx512f{ false };
+		bool avx512bw{ false };
+		bool bmi2{ false };
+
+		// In bytes, 0 if unknown. L1 is the data cache of one core, L3 is usually shared.
+		std::size_t l1Cache{ 0 };
+		std::size_t l2Cache{ 0 };
+		std::size_t l3Cache{ 0 };
+		std::size_t cacheLine{ 64 };
+	};
+
+	// Reads something like "48K" or "2048K" from Linux's /sys/devices/system/cpu files
+	inline std::size_t readSysfsSize(const std::string& path)
+	{
+		std::ifstream file{ path };
+		std::size_t value{ 0 };
+		char unit{};
+		if (!(file >> value))
+			return 0;
+		if (file >> unit)
+		{
+			if (unit == 'K')
+				value *= 1024;
+			else if (unit == 'M')
+				value *= 1024 * 1024;
+		}
+		return value;
+	}
+
+	inline void detectCaches(Features& f)
+	{
+#ifdef _WIN32
+		DWORD bytes{ 0 };
+		GetLogicalProcessorInformation(nullptr, &bytes);
+		const DWORD count{ bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) };
+		SYSTEM_LOGICAL_PROCESSOR_INFORMATION* info{ new SYSTEM_LOGICAL_PROCESSOR_INFORMATION[count] };
+		if (GetLogicalProcessorInformation(info, &bytes))
+		{
+			for (DWORD i{ 0 }; i < count; ++i)
+			{
+				if (info[i].Relationship != RelationCache)
+					continue;
+				const CACHE_DESCRIPTOR& cache{ info[i].Cache };
+				if (cache.Level == 1 && cache.Type != CacheInstruction)
+					f.l1Cache = cache.Size;
+				else if (cache.Level == 2)
+					f.l2Cache = cache.Size;
+				else if (cache.Level == 3)
+					f.l3Cache = cache.Size;
+				f.cacheLine = cache.LineSize;
+			}
+		}
+		delete[] info;
+#else
+		// index0 is usually L1 data, index1 L1 instruction, index2 L2, index3 L3
+		const std::string base{ "/sys/devices/system/cpu/cpu0/cache/index" };
+		for (int index{ 0 }; index < 8; ++index)
+		{
+			const std::string dir{ base + std::to_string(index) + '/' };
+			std::ifstream levelFile{ dir + "level" };
+			std::ifstream typeFile{ dir + "type" };
+			int level{ 0 };
+			std::string type{};
+			if (!(levelFile >> level) || !(typeFile >> type))
+				break;
+			if (type == "Instruction")
+				continue;
+
+			const std::size_t size{ readSysfsSize(dir + "size") };
+			if (level == 1)
+				f.l1Cache = size;
+			else if (level == 2)
+				f.l2Cache = size;
+			else if (level == 3)
+				f.l3Cache = size;
+
+			if (const std::size_t line{ readSysfsSize(dir + "coherency_line_size") }; line > 0)
+				f.cacheLine = line;
+		}
+#endif
+		// Sensible guesses if the OS didn't tell us
+		if (f.l1Cache == 0)
+			f.l1Cache = 32 * 1024;
+		if (f.l2Cache == 0)
+			f.l2Cache = 256 * 1024;
+	}
+
+	inline Features detect()
+	{
+		Features f{};
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		// These also check the OS saves the wide registers on a context switch
+		__builtin_cpu_init();
+		f.sse42 = __builtin_cpu_supports("sse4.2");
+		f.avx2 = __builtin_cpu_supports("avx2");
+		f.avx512f = __builtin_cpu_supports("avx512f");
+		f.avx512bw = __builtin_cpu_supports("avx512bw");
+		f.bmi2 = __builtin_cpu_supports("bmi2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		int regs[4]{};
+		__cpuid(regs, 1);
+		f.sse42 = (regs[2] >> 20) & 1;
+		const bool osSavesAvx{ ((regs[2] >> 27) & 1) && (_xgetbv(0) & 0x6) == 0x6 };
+		const bool osSavesAvx512{ osSavesAvx && (_xgetbv(0) & 0xE6) == 0xE6 };
+		__cpuidex(regs, 7, 0);
+		f.avx2 = osSavesAvx && ((regs[1] >> 5) & 1);
+		f.bmi2 = (regs[1] >> 8) & 1;
+		f.avx512f = osSavesAvx512 && ((regs[1] >> 16) & 1);
+		f.avx512bw = osSavesAvx512 && ((regs[1] >> 30) & 1);
+#endif
+		detectCaches(f);
+		return f;
+	}
+
+	// Detected once, the first time anybody asks
+	inline const Features& features()
+	{
+		static const Features f{ detect() };
+		return f;
+	}
+
+	inline Tier hardwareTier()
+	{
+		const Features& f{ features() };
+		if (f.avx512f && f.avx512bw && f.avx2 && f.bmi2)
+			return Tier::avx512;
+		if (f.avx2 && f.bmi2)
+			return Tier::avx2;
+		if (f.sse42)
+			return Tier::sse42;
+		return Tier::scalar;
+	}
+
+	// The hardware tier, lowered by LEARNCPP_SIMD if it's set
+	inline Tier activeTier()
+	{
+		static const Tier tier{ [] {
+			const Tier hardware{ hardwareTier() };
+			const char* env{ std::getenv("LEARNCPP_SIMD") };
+			if (!env)
+				return hardware;
+
+			for (Tier t : { Tier::scalar, Tier::sse42, Tier::avx2, Tier::avx512 })
+			{
+				if (tierName(t) == env || (t == Tier::sse42 && std::string_view{ env } == "sse42"))
+					return t < hardware ? t : hardware;
+			}
+			return hardware;
+		}() };
+		return tier;
+	}
+
+	// One implementation per tier. Leave a tier as nullptr if you didn't write that version;
+	// select() then falls back to the next lower one. The scalar version is required.
+	template <typename Fn>
+	struct Implementations
+	{
+		Fn scalar{ nullptr };
+		Fn sse42{ nullptr };
+		Fn avx2{ nullptr };
+		Fn avx512{ nullptr };
+	};
+
+	// Sample call:
+	//     static const auto sum{ CpuFeatures::select<SumFn>({ sumScalar, nullptr, sumAvx2 }) };
+	//     sum(data, n);
+	template <typename Fn>
+	Fn select(const Implementations<Fn>& impls)
+	{
+		const Tier tier{ activeTier() };
+		if (tier >= Tier::avx512 && impls.avx512)
+			return impls.avx512;
+		if (tier >= Tier::avx2 && impls.avx2)
+			return impls.avx2;
+		if (tier >= Tier::sse42 && impls.sse42)
+			return impls.sse42;
+		return impls.scalar;
+	}
+
+	// Which tier select() would pick for these implementations (handy for printing)
+	template <typename Fn>
+	Tier selectedTier(const Implementations<Fn>& impls)
+	{
+		const Fn chosen{ select(impls) };
+		if (chosen == impls.avx512)
+			return Tier::avx512;
+		if (chosen == impls.avx2)
+			return Tier::avx2;
+		if (chosen == impls.sse42)
+			return Tier::sse42;
+		return Tier::scalar;
+	}
+}
+
+#endif // CPU_FEATURES_H
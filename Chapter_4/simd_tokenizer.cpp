@@ -0,0 +1,335 @@
+// char.cpp reads one character at a time with std::cin.get(), and getName() in
+// Chapter_5/quiz_q4.cpp relies on std::cin >> std::ws to skip whitespace one char at a time.
+//
+// This tokenizer works on a buffer that's already in memory. It looks at 64 bytes at a time:
+// one SIMD compare per character class gives a 64-bit mask (bit i set = byte i is whitespace or
+// a delimiter), and a few bit operations on that mask give the start and end of every token in
+// the block. Tokens come out as std::string_view pointing into the buffer, so nothing
+// is copied.
+//
+// The compare kernel exists in scalar, SSE4.2, AVX2 and AVX-512 versions; cpu_features.h picks
+// the best one for this CPU at startup (LEARNCPP_SIMD=scalar forces the slow one for testing).
+
+#include <algorithm> // for std::min
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring> // for std::memcpy, std::memset
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <immintrin.h>
+#include "cpu_features.h"
+
+// Whitespace is ' ' and '\t' '\n' '\v' '\f' '\r' (the same set std::ws skips).
+// On top of that the caller can name up to 4 extra delimiter characters, like ',' or ';'.
+struct Separators
+{
+    std::array<char, 4> extra{ ' ', ' ', ' ', ' ' }; // unused slots are ' ', which is already a separator
+};
+
+Separators makeSeparators(std::string_view delimiters)
+{
+    Separators seps{};
+    for (std::size_t i{ 0 }; i < delimiters.size() && i < seps.extra.size(); ++i)
+        seps.extra[i] = delimiters[i];
+    return seps;
+}
+
+// Result of looking at one 64-byte block
+struct BlockMasks
+{
+    std::uint64_t separators{}; // bit i set if byte i is whitespace or a delimiter
+    std::uint64_t newlines{};   // bit i set if byte i is '\n'
+};
+
+using ClassifyFn = BlockMasks (*)(const char* block, const Separators& seps);
+
+bool isSeparator(char ch, const Separators& seps)
+{
+    const bool whitespace{ ch == ' ' || (ch >= '\t' && ch <= '\r') };
+    return whitespace || ch == seps.extra[0] || ch == seps.extra[1] || ch == seps.extra[2] || ch == seps.extra[3];
+}
+
+// The per-character version, for CPUs (or builds) without SIMD
+BlockMasks classifyScalar(const char* block, const Separators& seps)
+{
+    BlockMasks masks{};
+    for (std::size_t i{ 0 }; i < 64; ++i)
+    {
+        masks.separators |= std::uint64_t{ isSeparator(block[i], seps) } << i;
+        masks.newlines |= std::uint64_t{ block[i] == '\n' } << i;
+    }
+    return masks;
+}
+
+// 16 bytes at a time, four times
+CPU_TARGET_SSE42 BlockMasks classifySse42(const char* block, const Separators& seps)
+{
+    const __m128i space{ _mm_set1_epi8(' ') };
+    const __m128i tab{ _mm_set1_epi8('\t') };
+    const __m128i four{ _mm_set1_epi8(4) };
+    const __m128i newline{ _mm_set1_epi8('\n') };
+
+    BlockMasks masks{};
+    for (int part{ 0 }; part < 4; ++part)
+    {
+        const __m128i x{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + part * 16)) };
+        // '\t'..'\r' is a range of 5: (x - '\t') <= 4 as unsigned bytes, i.e. min(x - '\t', 4) == x - '\t'
+        const __m128i offset{ _mm_sub_epi8(x, tab) };
+        __m128i sep{ _mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(_mm_min_epu8(offset, four), offset)) };
+        for (char extra : seps.extra)
+            sep = _mm_or_si128(sep, _mm_cmpeq_epi8(x, _mm_set1_epi8(extra)));
+
+        masks.separators |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(sep))) << (part * 16);
+        masks.newlines |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, newline)))) << (part * 16);
+    }
+    return masks;
+}
+
+CPU_TARGET_AVX2 BlockMasks classifyAvx2(const char* block, const Separators& seps)
+{
+    const __m256i space{ _mm256_set1_epi8(' ') };
+    const __m256i tab{ _mm256_set1_epi8('\t') };
+    const __m256i four{ _mm256_set1_epi8(4) };
+    const __m256i newline{ _mm256_set1_epi8('\n') };
+
+    BlockMasks masks{};
+    for (int part{ 0 }; part < 2; ++part)
+    {
+        const __m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + part * 32)) };
+        const __m256i offset{ _mm256_sub_epi8(x, tab) };
+        __m256i sep{ _mm256_or_si256(_mm256_cmpeq_epi8(x, space), _mm256_cmpeq_epi8(_mm256_min_epu8(offset, four), offset)) };
+        for (char extra : seps.extra)
+            sep = _mm256_or_si256(sep, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(extra)));
+
+        masks.separators |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(sep))) << (part * 32);
+        masks.newlines |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, newline)))) << (part * 32);
+    }
+    return masks;
+}
+
+// AVX-512BW compares straight into a 64-bit mask register, no movemask needed
+CPU_TARGET_AVX512 BlockMasks classifyAvx512(const char* block, const Separators& seps)
+{
+    const __m512i x{ _mm512_loadu_si512(block) };
+    const __m512i offset{ _mm512_sub_epi8(x, _mm512_set1_epi8('\t')) };
+
+    __mmask64 sep{ _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(' ')) | _mm512_cmple_epu8_mask(offset, _mm512_set1_epi8(4)) };
+    for (char extra : seps.extra)
+        sep |= _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(extra));
+
+    return { sep, _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('\n')) };
+}
+
+constexpr CpuFeatures::Implementations<ClassifyFn> classifyImpls{ classifyScalar, classifySse42, classifyAvx2, classifyAvx512 };
+
+ClassifyFn bestClassifier()
+{
+    static const ClassifyFn best{ CpuFeatures::select(classifyImpls) };
+    return best;
+}
+
+struct Token
+{
+    std::string_view text{};
+    std::size_t line{}; // 1-based line the token is on
+};
+
+// Tokens are found from the masks with bit tricks instead of checking bytes one by one:
+//     wordBytes = ~separators
+//     starts    = word bytes whose previous byte was a separator
+//     ends      = separator bytes whose previous byte was a word byte
+// ("previous byte" for bit 0 is the last byte of the block before, carried over.)
+// Starts and ends alternate, so the next token is always "lowest start bit, then lowest end bit".
+class Tokenizer
+{
+public:
+    explicit Tokenizer(std::string_view text, std::string_view delimiters = "", ClassifyFn classify = bestClassifier())
+        : m_text{ text }, m_seps{ makeSeparators(delimiters) }, m_classify{ classify }
+    {
+        loadBlock(0);
+    }
+
+    // Sample use:
+    //     Token token{};
+    //     while (tokenizer.next(token))
+    //         std::cout << token.text << '\n';
+    bool next(Token& token)
+    {
+        while (m_starts == 0)
+        {
+            if (!loadNextBlock())
+                return false;
+        }
+
+        const std::uint64_t startBit{ m_starts & (~m_starts + 1) }; // lowest set bit on its own
+        m_starts ^= startBit;
+        const std::size_t start{ m_blockStart + static_cast<std::size_t>(__builtin_ctzll(startBit)) };
+        token.line = m_linesBefore + static_cast<std::size_t>(__builtin_popcountll(m_masks.newlines & (startBit - 1))) + 1;
+
+        // The end may be in a later block if the token crosses a 64-byte boundary
+        while (m_ends == 0)
+        {
+            if (!loadNextBlock())
+            {
+                token.text = m_text.substr(start); // token runs to the very end of the text
+                return true;
+            }
+        }
+
+        const std::uint64_t endBit{ m_ends & (~m_ends + 1) };
+        m_ends ^= endBit;
+        const std::size_t end{ std::min(m_blockStart + static_cast<std::size_t>(__builtin_ctzll(endBit)), m_text.size()) };
+        token.text = m_text.substr(start, end - start);
+        return true;
+    }
+
+private:
+    void loadBlock(std::size_t blockStart)
+    {
+        m_blockStart = blockStart;
+        if (m_text.empty())
+            return; // no tokens, and data() may be null, so don't memcpy from it below
+
+        if (blockStart + 64 <= m_text.size())
+        {
+            m_masks = m_classify(m_text.data() + blockStart, m_seps);
+        }
+        else
+        {
+            // Last partial block: copy it out and pad with spaces so we never read past the buffer
+            char padded[64];
+            std::memset(padded, ' ', sizeof(padded));
+            std::memcpy(padded, m_text.data() + blockStart, m_text.size() - blockStart);
+            m_masks = m_classify(padded, m_seps);
+        }
+
+        const std::uint64_t wordBytes{ ~m_masks.separators };
+        const std::uint64_t previousIsWord{ (wordBytes << 1) | m_carry };
+        m_starts = wordBytes & ~previousIsWord;
+        m_ends = m_masks.separators & previousIsWord;
+        m_carry = wordBytes >> 63;
+    }
+
+    // Kept out of line: it runs once per 64 bytes, and leaving it out lets next() inline into the caller's loop
+    [[gnu::noinline]] bool loadNextBlock()
+    {
+        if (m_blockStart + 64 >= m_text.size())
+            return false;
+
+        m_linesBefore += static_cast<std::size_t>(__builtin_popcountll(m_masks.newlines));
+        loadBlock(m_blockStart + 64);
+        return true;
+    }
+
+    std::string_view m_text{};
+    Separators m_seps{};
+    ClassifyFn m_classify{};
+
+    std::size_t m_blockStart{ 0 };
+    std::size_t m_linesBefore{ 0 }; // newlines in all blocks before this one
+    BlockMasks m_masks{};
+    std::uint64_t m_starts{ 0 };
+    std::uint64_t m_ends{ 0 };
+    std::uint64_t m_carry{ 0 }; // 1 if the last byte of the previous block was a word byte
+};
+
+// The old way, a character at a time (like calling std::cin.get() in a loop)
+std::size_t countTokensPerChar(std::string_view text, std::size_t& totalLength)
+{
+    const Separators seps{ makeSeparators(",") };
+    std::size_t tokens{ 0 };
+    bool inToken{ false };
+    for (char ch : text)
+    {
+        const bool sep{ isSeparator(ch, seps) };
+        if (!sep)
+            ++totalLength;
+        if (!sep && !inToken)
+            ++tokens;
+        inToken = !sep;
+    }
+    return tokens;
+}
+
+std::string makeText(std::size_t bytes)
+{
+    constexpr std::array<std::string_view, 8> words{ "Alex", "apples", "42", "Lebron James", "x", "tokenizer", "3.14", "hello,world" };
+    std::mt19937 mt{ 5 };
+    std::string text{};
+    text.reserve(bytes + 32);
+    while (text.size() < bytes)
+    {
+        text += words[mt() % words.size()];
+        text += (mt() % 8 == 0) ? "\n" : ((mt() % 4 == 0) ? "  \t" : " ");
+    }
+    return text;
+}
+
+template <typename Fn>
+void report(const char* name, std::size_t bytes, Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    std::size_t totalLength{ 0 };
+    const std::size_t tokens{ fn(totalLength) };
+    const std::chrono::duration<double> seconds{ std::chrono::steady_clock::now() - start };
+    std::cout << name << tokens << " tokens, " << totalLength << " chars, " << bytes / seconds.count() / 1e9 << " GB/s\n";
+}
+
+int main()
+{
+    Tokenizer demo{ "  Mary has\t3 apples,\nJohn has 5;;  \n  done", ",;" };
+    Token token{};
+    while (demo.next(token))
+        std::cout << "line " << token.line << ": [" << token.text << "]\n";
+    Tokenizer empty{ std::string_view{} }; // data() is null
+    std::cout << "empty input: " << (empty.next(token) ? "a token?!" : "no tokens") << '\n';
+
+    const std::string text{ makeText(64 * 1024 * 1024) };
+    std::cout << "\nTokenizing " << text.size() / (1024 * 1024) << " MiB (best kernel: "
+              << CpuFeatures::tierName(CpuFeatures::selectedTier(classifyImpls)) << ")\n";
+
+    report("std::istringstream >> std::string: ", text.size(), [&](std::size_t& totalLength) {
+        std::istringstream in{ text };
+        std::string word{};
+        std::size_t tokens{ 0 };
+        while (in >> word) // doesn't split on ',' so its token count is a little lower
+        {
+            ++tokens;
+            totalLength += word.size();
+        }
+        return tokens;
+    });
+
+    report("one char at a time:              ", text.size(), [&](std::size_t& totalLength) {
+        return countTokensPerChar(text, totalLength);
+    });
+
+    for (CpuFeatures::Tier tier : { CpuFeatures::Tier::scalar, CpuFeatures::Tier::sse42, CpuFeatures::Tier::avx2, CpuFeatures::Tier::avx512 })
+    {
+        if (tier > CpuFeatures::activeTier())
+            break;
+
+        const ClassifyFn classify{ tier == CpuFeatures::Tier::scalar ? classifyImpls.scalar
+                                   : tier == CpuFeatures::Tier::sse42 ? classifyImpls.sse42
+                                   : tier == CpuFeatures::Tier::avx2  ? classifyImpls.avx2
+                                                                      : classifyImpls.avx512 };
+        const std::string name{ "Tokenizer (" + std::string{ CpuFeatures::tierName(tier) } + "):" };
+        report((name + std::string(34 - name.size(), ' ')).c_str(), text.size(), [&](std::size_t& totalLength) {
+            Tokenizer tokenizer{ text, ",", classify };
+            Token t{};
+            std::size_t tokens{ 0 };
+            while (tokenizer.next(t))
+            {
+                ++tokens;
+                totalLength += t.text.size();
+            }
+            return tokens;
+        });
+    }
+
+    return 0;
+}
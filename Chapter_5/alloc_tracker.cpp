@@ -0,0 +1,503 @@
+// Replaces the global operator new and delete to count allocations; see alloc_tracker.h.
+// Link this file into a program (it has no main()), e.g.:
+//     g++ -O2 -pthread quiz_q4.cpp alloc_tracker.cpp
+// For readable names in the sampled call stacks, also pass -g -rdynamic.
+//
+// Keeping it cheap enough to leave on:
+//  - Each thread has its own block of counters, created on its first allocation and never freed
+//    (so the numbers outlive the thread). Only the owning thread writes them, with plain
+//    load + store, so there are no locked instructions and no cache line bouncing between threads.
+//  - The size of a block being freed comes from malloc itself (malloc_usable_size and friends),
+//    so nothing extra is stored next to each allocation.
+//  - Whole-program live memory needs one shared counter. Each thread only adds to it once its own
+//    change reaches 64 KiB, so the peak is exact to within 64 KiB per thread.
+//  - Call stacks are only recorded for 1 in N allocations, and only if asked for.
+
+#include "alloc_tracker.h"
+
+#include <algorithm> // for std::copy, std::min, std::max
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib> // for std::malloc, std::free, std::getenv, std::atexit
+#include <cstring> // for std::strchr
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h> // for _msize, _aligned_malloc, _aligned_msize, _aligned_free
+#elif defined(__APPLE__)
+#include <malloc/malloc.h> // for malloc_size
+#else
+#include <malloc.h> // for malloc_usable_size
+#endif
+
+#if defined(__GLIBC__)
+#include <cxxabi.h>   // for abi::__cxa_demangle
+#include <execinfo.h> // for backtrace, backtrace_symbols
+#define ALLOC_TRACKER_CAN_SAMPLE 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ALLOC_TRACKER_INLINE __attribute__((always_inline)) inline
+#define ALLOC_TRACKER_NOINLINE __attribute__((noinline))
+#else
+#define ALLOC_TRACKER_INLINE __forceinline
+#define ALLOC_TRACKER_NOINLINE __declspec(noinline)
+#endif
+
+namespace
+{
+    // ---- Asking malloc for memory and for the size of a block ----
+
+    void* mallocAligned(std::size_t size, std::size_t alignment)
+    {
+#ifdef _WIN32
+        return _aligned_malloc(size ? size : 1, alignment);
+#else
+        // aligned_alloc wants the size to be a multiple of the alignment, and new(0) must still
+        // return a unique pointer, which aligned_alloc(alignment, 0) doesn't promise
+        const std::size_t atLeastOne{ size ? size : 1 };
+        return std::aligned_alloc(alignment, (atLeastOne + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void freeAligned(void* ptr)
+    {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+
+    std::size_t blockSize(void* ptr, std::size_t alignment)
+    {
+#if defined(_WIN32)
+        return alignment == 0 ? _msize(ptr) : _aligned_msize(ptr, alignment, 0);
+#elif defined(__APPLE__)
+        (void)alignment;
+        return malloc_size(ptr);
+#else
+        (void)alignment;
+        return malloc_usable_size(ptr);
+#endif
+    }
+
+    // ---- Counters ----
+
+    constexpr std::int64_t flushThreshold{ 64 * 1024 };
+
+    struct ThreadCounters
+    {
+        std::atomic<std::uint64_t> allocations{};
+        std::atomic<std::uint64_t> frees{};
+        std::atomic<std::uint64_t> bytesRequested{};
+        std::atomic<std::uint64_t> bytesAllocated{};
+        std::atomic<std::uint64_t> bytesFreed{};
+        std::atomic<std::int64_t> peakLive{};
+
+        // Only touched by the owning thread
+        std::int64_t unflushedLive{ 0 }; // change in live bytes not yet added to g_live
+        unsigned untilSample{ 1 }; // allocations until the next call stack sample (or check whether sampling is on)
+
+        unsigned id{};
+        ThreadCounters* next{};
+        char padding[64]{}; // keeps the next thread's counters off our last cache line
+    };
+
+    std::atomic<ThreadCounters*> g_threads{ nullptr }; // every thread's counters, newest first
+    std::atomic<unsigned> g_threadCount{ 0 };
+    std::atomic<std::int64_t> g_live{ 0 };
+    std::atomic<std::int64_t> g_peakLive{ 0 };
+    std::atomic<unsigned> g_sampleEvery{ 0 };
+
+    // Plain (not function-local) thread_locals with constant initializers cost nothing to reach
+    thread_local ThreadCounters* t_counters{ nullptr };
+    thread_local bool t_inTracker{ false }; // true while we're sampling, so malloc calls in there aren't sampled
+
+    // Only the owning thread ever writes its counters, so a relaxed load + store is enough
+    template <typename T>
+    ALLOC_TRACKER_INLINE void bump(std::atomic<T>& counter, T amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    ALLOC_TRACKER_NOINLINE ThreadCounters& newThreadCounters()
+    {
+        // Straight from malloc: calling new in here would come back to us
+        void* memory{ std::malloc(sizeof(ThreadCounters)) };
+        if (!memory)
+            std::abort();
+        ThreadCounters* counters{ new (memory) ThreadCounters{} };
+        counters->id = g_threadCount.fetch_add(1) + 1;
+        counters->next = g_threads.load();
+        while (!g_threads.compare_exchange_weak(counters->next, counters))
+        {
+        }
+        t_counters = counters;
+        return *counters;
+    }
+
+    ALLOC_TRACKER_INLINE ThreadCounters& counters()
+    {
+        return t_counters ? *t_counters : newThreadCounters();
+    }
+
+    void raisePeak(std::atomic<std::int64_t>& peak, std::int64_t value)
+    {
+        std::int64_t old{ peak.load(std::memory_order_relaxed) };
+        while (value > old && !peak.compare_exchange_weak(old, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    ALLOC_TRACKER_INLINE void changeLive(ThreadCounters& c, std::int64_t delta)
+    {
+        c.unflushedLive += delta;
+        if (c.unflushedLive >= flushThreshold || c.unflushedLive <= -flushThreshold)
+        {
+            const std::int64_t live{ g_live.fetch_add(c.unflushedLive, std::memory_order_relaxed) + c.unflushedLive };
+            c.unflushedLive = 0;
+            raisePeak(g_peakLive, live);
+        }
+    }
+
+    // ---- Sampled call stacks ----
+
+    constexpr int maxFrames{ 16 };
+    constexpr std::size_t maxCallSites{ 4096 };
+
+    struct CallSite
+    {
+        std::uint64_t hash{}; // 0 = empty slot
+        std::uint64_t allocations{}; // estimates: every sample counts for the allocations it stands for
+        std::uint64_t bytes{};
+        int frames{};
+        void* stack[maxFrames]{};
+    };
+
+    // A fixed table, so recording a sample never allocates. Sampling is rare, so a spinlock is fine.
+    CallSite g_callSites[maxCallSites]{};
+    std::atomic_flag g_callSitesLock = ATOMIC_FLAG_INIT;
+    std::atomic<std::uint64_t> g_droppedSamples{ 0 };
+
+    // Each sample stands for `every` allocations, so it's counted that many times
+    ALLOC_TRACKER_NOINLINE void sample(std::size_t bytes, unsigned every)
+    {
+#ifdef ALLOC_TRACKER_CAN_SAMPLE
+        t_inTracker = true;
+        // Frame 0 is this function, frame 1 the operator new that called it
+        void* stack[maxFrames + 2];
+        const int frames{ backtrace(stack, maxFrames + 2) - 2 };
+        std::uint64_t hash{ 14695981039346656037ull }; // FNV-1a over the return addresses
+        for (int i{ 0 }; i < frames; ++i)
+            hash = (hash ^ reinterpret_cast<std::uintptr_t>(stack[i + 2])) * 1099511628211ull;
+        hash |= 1;
+
+        while (g_callSitesLock.test_and_set(std::memory_order_acquire))
+        {
+        }
+        bool recorded{ false };
+        for (std::size_t probes{ 0 }, slot{ hash % maxCallSites }; probes < maxCallSites && !recorded; ++probes, slot = (slot + 1) % maxCallSites)
+        {
+            CallSite& site{ g_callSites[slot] };
+            if (site.hash == 0)
+            {
+                site.hash = hash;
+                site.frames = frames;
+                std::copy(stack + 2, stack + 2 + frames, site.stack);
+            }
+            if (site.hash == hash)
+            {
+                site.allocations += every;
+                site.bytes += static_cast<std::uint64_t>(bytes) * every;
+                recorded = true;
+            }
+        }
+        if (!recorded)
+            g_droppedSamples.fetch_add(1, std::memory_order_relaxed); // the table is full
+        g_callSitesLock.clear(std::memory_order_release);
+        t_inTracker = false;
+#else
+        (void)bytes;
+        (void)every;
+#endif
+    }
+
+    // ---- The bookkeeping every allocation and free goes through ----
+
+    ALLOC_TRACKER_INLINE void recordAllocation(void* ptr, std::size_t requested, std::size_t alignment)
+    {
+        ThreadCounters& c{ counters() };
+        const std::size_t size{ blockSize(ptr, alignment) };
+        bump(c.allocations, std::uint64_t{ 1 });
+        bump(c.bytesRequested, static_cast<std::uint64_t>(requested));
+        bump(c.bytesAllocated, static_cast<std::uint64_t>(size));
+
+        const std::int64_t live{ static_cast<std::int64_t>(c.bytesAllocated.load(std::memory_order_relaxed) - c.bytesFreed.load(std::memory_order_relaxed)) };
+        if (live > c.peakLive.load(std::memory_order_relaxed))
+            c.peakLive.store(live, std::memory_order_relaxed);
+        changeLive(c, static_cast<std::int64_t>(size));
+
+        if (--c.untilSample == 0)
+        {
+            // With sampling off, look again every 4096 allocations in case it's been turned on
+            const unsigned every{ g_sampleEvery.load(std::memory_order_relaxed) };
+            c.untilSample = every != 0 ? every : 4096;
+            if (every != 0 && !t_inTracker)
+                sample(size, every);
+        }
+    }
+
+    ALLOC_TRACKER_INLINE void recordFree(void* ptr, std::size_t alignment)
+    {
+        ThreadCounters& c{ counters() };
+        const std::size_t size{ blockSize(ptr, alignment) };
+        bump(c.frees, std::uint64_t{ 1 });
+        bump(c.bytesFreed, static_cast<std::uint64_t>(size));
+        changeLive(c, -static_cast<std::int64_t>(size));
+    }
+
+    // alignment 0 means "whatever malloc gives" (enough for any normal type)
+    ALLOC_TRACKER_INLINE void* allocate(std::size_t size, std::size_t alignment)
+    {
+        for (;;)
+        {
+            void* ptr{ alignment == 0 ? std::malloc(size ? size : 1) : mallocAligned(size, alignment) };
+            if (ptr)
+            {
+                recordAllocation(ptr, size, alignment);
+                return ptr;
+            }
+            // Out of memory: the standard says to call the new handler (which may free something) and retry
+            const std::new_handler handler{ std::get_new_handler() };
+            if (!handler)
+                throw std::bad_alloc{};
+            handler();
+        }
+    }
+
+    ALLOC_TRACKER_INLINE void* allocateNoThrow(std::size_t size, std::size_t alignment) noexcept
+    {
+        try
+        {
+            return allocate(size, alignment);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    ALLOC_TRACKER_INLINE void deallocate(void* ptr, std::size_t alignment) noexcept
+    {
+        if (!ptr)
+            return;
+        recordFree(ptr, alignment);
+        if (alignment == 0)
+            std::free(ptr);
+        else
+            freeAligned(ptr);
+    }
+
+    // ---- The summary ----
+
+    double mebibytes(std::uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+    AllocTracker::Stats statsOf(const ThreadCounters& c)
+    {
+        AllocTracker::Stats s{};
+        s.allocations = c.allocations.load(std::memory_order_relaxed);
+        s.frees = c.frees.load(std::memory_order_relaxed);
+        s.bytesRequested = c.bytesRequested.load(std::memory_order_relaxed);
+        s.bytesAllocated = c.bytesAllocated.load(std::memory_order_relaxed);
+        s.bytesFreed = c.bytesFreed.load(std::memory_order_relaxed);
+        s.liveBytes = static_cast<std::int64_t>(s.bytesAllocated - s.bytesFreed);
+        s.peakLiveBytes = c.peakLive.load(std::memory_order_relaxed);
+        return s;
+    }
+
+#ifdef ALLOC_TRACKER_CAN_SAMPLE
+    // backtrace_symbols gives lines like "./prog(_Z7getNamei+0x2f) [0x5581...]"; print the name demangled
+    void printFrame(std::FILE* out, char* symbol)
+    {
+        char* open{ std::strchr(symbol, '(') };
+        char* plus{ open ? std::strchr(open, '+') : nullptr };
+        if (open && plus && plus > open + 1)
+        {
+            *plus = '\0';
+            int status{ -1 };
+            char* demangled{ abi::__cxa_demangle(open + 1, nullptr, nullptr, &status) };
+            *plus = '+';
+            if (status == 0 && demangled)
+            {
+                std::fprintf(out, "        %s\n", demangled);
+                std::free(demangled);
+                return;
+            }
+        }
+        std::fprintf(out, "        %s\n", symbol);
+    }
+
+    void printCallSites(std::FILE* out)
+    {
+        constexpr std::size_t shown{ 8 };
+        std::size_t used{ 0 };
+        CallSite* top[shown]{};
+        for (CallSite& site : g_callSites)
+        {
+            if (site.hash == 0)
+                continue;
+            // Keep the `shown` biggest, sorted by bytes
+            std::size_t pos{ std::min(used, shown) };
+            while (pos > 0 && top[pos - 1]->bytes < site.bytes)
+            {
+                if (pos < shown)
+                    top[pos] = top[pos - 1];
+                --pos;
+            }
+            if (pos < shown)
+                top[pos] = &site;
+            ++used;
+        }
+
+        if (used == 0)
+            return;
+        std::fprintf(out, "  top call sites (estimated from sampled call stacks):\n");
+        for (std::size_t i{ 0 }; i < std::min(used, shown); ++i)
+        {
+            std::fprintf(out, "    ~%llu allocations, ~%.2f MiB from:\n", static_cast<unsigned long long>(top[i]->allocations),
+                         mebibytes(top[i]->bytes));
+            char** symbols{ backtrace_symbols(top[i]->stack, top[i]->frames) };
+            for (int f{ 0 }; symbols && f < top[i]->frames; ++f)
+                printFrame(out, symbols[f]);
+            std::free(symbols);
+        }
+        if (const std::uint64_t dropped{ g_droppedSamples.load() })
+            std::fprintf(out, "    (%llu samples dropped, the call site table was full)\n", static_cast<unsigned long long>(dropped));
+    }
+#endif
+
+    void printAtExit()
+    {
+        std::fflush(stdout); // so the summary comes after the program's own output
+        AllocTracker::printSummary(stderr);
+    }
+
+    // Reads the environment variables and registers the summary, before main() runs
+    const bool g_started{ [] {
+        if (const char* every{ std::getenv("ALLOC_TRACKER_SAMPLE") })
+            AllocTracker::setSampleEvery(static_cast<unsigned>(std::strtoul(every, nullptr, 10)));
+        const char* quiet{ std::getenv("ALLOC_TRACKER_QUIET") };
+        if (!quiet || *quiet == '0')
+            std::atexit(printAtExit);
+        return true;
+    }() };
+}
+
+namespace AllocTracker
+{
+    Stats threadStats()
+    {
+        return statsOf(counters());
+    }
+
+    Stats totalStats()
+    {
+        Stats total{};
+        for (const ThreadCounters* c{ g_threads.load() }; c; c = c->next)
+        {
+            const Stats s{ statsOf(*c) };
+            total.allocations += s.allocations;
+            total.frees += s.frees;
+            total.bytesRequested += s.bytesRequested;
+            total.bytesAllocated += s.bytesAllocated;
+            total.bytesFreed += s.bytesFreed;
+        }
+        total.liveBytes = static_cast<std::int64_t>(total.bytesAllocated - total.bytesFreed);
+        total.peakLiveBytes = std::max(g_peakLive.load(), total.liveBytes);
+        return total;
+    }
+
+    void setSampleEvery(unsigned n)
+    {
+        g_sampleEvery.store(n, std::memory_order_relaxed);
+        if (t_counters)
+            t_counters->untilSample = 1; // the calling thread switches right away, the others within 4096 allocations
+    }
+
+    void printSummary(std::FILE* out)
+    {
+        const Stats total{ totalStats() };
+        std::fprintf(out, "\n[alloc tracker] %llu allocations, %llu frees, %.2f MiB requested (%.2f MiB from malloc)\n",
+                     static_cast<unsigned long long>(total.allocations), static_cast<unsigned long long>(total.frees),
+                     mebibytes(total.bytesRequested), mebibytes(total.bytesAllocated));
+        std::fprintf(out, "  live now: %.2f MiB, peak: %.2f MiB\n", static_cast<double>(total.liveBytes) / (1024.0 * 1024.0),
+                     static_cast<double>(total.peakLiveBytes) / (1024.0 * 1024.0));
+
+        // Oldest thread first (the list is newest first)
+        const ThreadCounters* threads[256]{};
+        std::size_t count{ 0 };
+        for (const ThreadCounters* c{ g_threads.load() }; c && count < 256; c = c->next)
+            threads[count++] = c;
+        if (count > 1)
+        {
+            std::fprintf(out, "  %-8s %14s %14s %14s %14s\n", "thread", "allocations", "frees", "MiB allocated", "peak MiB live");
+            for (std::size_t i{ count }; i-- > 0;)
+            {
+                const Stats s{ statsOf(*threads[i]) };
+                std::fprintf(out, "  %-8u %14llu %14llu %14.2f %14.2f\n", threads[i]->id, static_cast<unsigned long long>(s.allocations),
+                             static_cast<unsigned long long>(s.frees), mebibytes(s.bytesAllocated),
+                             static_cast<double>(s.peakLiveBytes) / (1024.0 * 1024.0));
+            }
+        }
+
+#ifdef ALLOC_TRACKER_CAN_SAMPLE
+        const bool wasInTracker{ t_inTracker };
+        t_inTracker = true;
+        printCallSites(out); // if any were sampled
+        t_inTracker = wasInTracker;
+#endif
+    }
+}
+
+// ---- The replacements. Every form of global new and delete has to be covered, or memory from one
+// kind could be freed by the other. ----
+
+void* operator new(std::size_t size) { return allocate(size, 0); }
+void* operator new[](std::size_t size) { return allocate(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size, 0); }
+
+void operator delete(void* ptr) noexcept { deallocate(ptr, 0); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr, 0); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr, 0); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr, 0); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr, 0); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr, 0); }
+
+// For types with alignas() bigger than malloc's (C++17)
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateNoThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateNoThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { deallocate(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { deallocate(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept { deallocate(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept { deallocate(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr, static_cast<std::size_t>(alignment));
+}
@@ -0,0 +1,47 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstdint>
+#include <cstdio>
+
+// std_string.cpp says std::string's dynamic allocation makes it "comparatively slow", and
+// arena_string.cpp counts operator new calls for its one benchmark. alloc_tracker.cpp does that
+// for any program, without changing it: link it in and it replaces the global operator new and
+// delete, counts every allocation, and prints a summary when the program exits.
+//
+//     g++ -O2 -pthread quiz_q4.cpp alloc_tracker.cpp
+//
+// Counts are kept per thread (so threads never fight over a counter) and added up when asked.
+// Set the environment variable ALLOC_TRACKER_SAMPLE=N to also record the call stack of every Nth
+// allocation; the summary then lists the call sites that allocated the most. ALLOC_TRACKER_QUIET=1
+// turns the summary off. This header is only needed to read the numbers from inside the program.
+namespace AllocTracker
+{
+    struct Stats
+    {
+        std::uint64_t allocations{};
+        std::uint64_t frees{};
+        std::uint64_t bytesRequested{}; // what the program asked for
+        std::uint64_t bytesAllocated{}; // what malloc actually handed out (a bit more, rounded up)
+        std::uint64_t bytesFreed{};
+        // Allocated minus freed. A thread that frees memory another thread allocated can go negative.
+        std::int64_t liveBytes{};
+        std::int64_t peakLiveBytes{};
+    };
+
+    // Everything the calling thread has done so far
+    Stats threadStats();
+
+    // All threads added up, including ones that have finished. peakLiveBytes is the peak of the
+    // whole program's live memory, accurate to within 64 KiB per thread.
+    Stats totalStats();
+
+    // Record the call stack of every nth allocation (0 turns it off). Only on glibc (Linux).
+    // Other threads pick the change up within 4096 of their allocations.
+    void setSampleEvery(unsigned n);
+
+    // The same summary that's printed at exit
+    void printSummary(std::FILE* out);
+}
+
+#endif // ALLOC_TRACKER_H
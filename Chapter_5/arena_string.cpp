@@ -0,0 +1,248 @@
+// std_string.cpp says std::string uses dynamic memory allocation, which is "comparatively slow".
+// Most names are short, and in getName()-style code they only live for a moment.
+// So here's a string type that:
+//  - keeps up to 47 chars inline (std::string's small string buffer is only 15 chars in libstdc++)
+//  - puts anything longer into a monotonic arena the caller hands in, instead of calling new
+//  - converts to and from std::string_view, so it works with printOlder()-style functions
+//
+// A monotonic arena only ever moves a pointer forward. Nothing is freed one at a time,
+// the whole arena is reset at once when the batch of names is done with.
+
+#include <algorithm> // for std::max, std::copy_n
+#include <chrono>
+#include <cstddef>
+#include <cstdlib> // for std::malloc, std::free
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Count every global operator new so the benchmark can show how many allocations happened
+static std::size_t g_heapAllocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+    ++g_heapAllocations;
+    if (void* ptr{ std::malloc(size) })
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// Bump allocator over a buffer the caller owns.
+// If the buffer runs out, it falls back to the heap in big blocks (and counts them).
+class MonotonicArena
+{
+public:
+    MonotonicArena(char* buffer, std::size_t size)
+        : m_buffer{ buffer }, m_size{ size }
+    {
+    }
+
+    ~MonotonicArena() { releaseOverflow(); }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    char* allocate(std::size_t bytes)
+    {
+        if (m_used + bytes > m_size)
+            grow(bytes);
+
+        char* ptr{ m_buffer + m_used };
+        m_used += bytes;
+        return ptr;
+    }
+
+    // Forget everything allocated so far. Strings that used this arena must not be used after this.
+    void reset()
+    {
+        releaseOverflow();
+        m_buffer = m_original;
+        m_size = m_originalSize;
+        m_used = 0;
+    }
+
+    std::size_t overflowBlocks() const { return m_overflow.size(); }
+
+private:
+    void grow(std::size_t bytes)
+    {
+        constexpr std::size_t blockSize{ 64 * 1024 };
+        const std::size_t size{ std::max(blockSize, bytes) };
+
+        m_overflow.push_back(new char[size]);
+        m_buffer = m_overflow.back();
+        m_size = size;
+        m_used = 0;
+    }
+
+    void releaseOverflow()
+    {
+        for (char* block : m_overflow)
+            delete[] block;
+        m_overflow.clear();
+    }
+
+    char* m_buffer{};
+    std::size_t m_size{};
+    std::size_t m_used{ 0 };
+
+    char* const m_original{ m_buffer };
+    const std::size_t m_originalSize{ m_size };
+    std::vector<char*> m_overflow{};
+};
+
+class ArenaString
+{
+public:
+    static constexpr std::size_t inlineCapacity{ 47 };
+
+    explicit ArenaString(MonotonicArena& arena)
+        : m_arena{ &arena }
+    {
+        m_inline[0] = '\0';
+    }
+
+    ArenaString(MonotonicArena& arena, std::string_view text)
+        : ArenaString{ arena }
+    {
+        append(text);
+    }
+
+    // Copies go into the same arena as the original
+    ArenaString(const ArenaString& other)
+        : ArenaString{ *other.m_arena, other.view() }
+    {
+    }
+
+    ArenaString& operator=(std::string_view text)
+    {
+        m_size = 0;
+        return append(text);
+    }
+
+    ArenaString& operator=(const ArenaString& other)
+    {
+        if (this != &other)
+            *this = other.view();
+        return *this;
+    }
+
+    ArenaString& append(std::string_view text)
+    {
+        const std::size_t newSize{ m_size + text.size() };
+        if (newSize > m_capacity)
+        {
+            // Grow into the arena. The old storage is simply abandoned (it's freed with the arena).
+            const std::size_t newCapacity{ std::max(newSize, m_capacity * 2) };
+            char* bigger{ m_arena->allocate(newCapacity + 1) };
+            std::copy_n(m_data, m_size, bigger);
+            m_data = bigger;
+            m_capacity = newCapacity;
+        }
+
+        std::copy_n(text.data(), text.size(), m_data + m_size);
+        m_size = newSize;
+        m_data[m_size] = '\0';
+        return *this;
+    }
+
+    ArenaString& operator+=(std::string_view text) { return append(text); }
+
+    std::size_t size() const { return m_size; }
+    std::size_t length() const { return m_size; } // like std::string::length()
+    bool isInline() const { return m_data == m_inline; }
+    const char* c_str() const { return m_data; }
+
+    std::string_view view() const { return { m_data, m_size }; }
+    operator std::string_view() const { return view(); }
+
+private:
+    MonotonicArena* m_arena{};
+    char m_inline[inlineCapacity + 1]{};
+    char* m_data{ m_inline };
+    std::size_t m_size{ 0 };
+    std::size_t m_capacity{ inlineCapacity };
+};
+
+bool operator==(const ArenaString& a, std::string_view b) { return a.view() == b; }
+
+std::ostream& operator<<(std::ostream& out, const ArenaString& str)
+{
+    return out << str.view();
+}
+
+// Same idea as printOlder() in quiz_q4.cpp: takes string_view, so ArenaString and std::string both work
+void printOlder(std::string_view name1, int age1, std::string_view name2, int age2)
+{
+    if (age1 > age2)
+        std::cout << name1 << " (age " << age1 << ") is older than " << name2 << " (age " << age2 << ").\n";
+    else
+        std::cout << name2 << " (age " << age2 << ") is older than " << name1 << " (age " << age1 << ").\n";
+}
+
+// Benchmark input: mix of short names, SSO-busting names, and a few long ones
+std::vector<std::string_view> makeParts()
+{
+    return { "Alex", "Lebron James", "Maximilian Alexander", "Cassandra Wilhelmina Featherstonehaugh", "Jo",
+             "Bartholomew Montgomery Fitzgerald-Worthington the Third of Somewhere" };
+}
+
+template <typename MakeName>
+double timeIt(std::size_t rounds, MakeName makeName, std::size_t& allocations)
+{
+    const std::size_t before{ g_heapAllocations };
+    const auto start{ std::chrono::steady_clock::now() };
+    for (std::size_t round{ 0 }; round < rounds; ++round)
+        makeName(round);
+    const std::chrono::duration<double> seconds{ std::chrono::steady_clock::now() - start };
+    allocations = g_heapAllocations - before;
+    return seconds.count();
+}
+
+int main()
+{
+    // One 1 MiB buffer on the heap up front; nothing else should hit the heap in the loop
+    std::vector<char> storage(1 << 20);
+    MonotonicArena arena{ storage.data(), storage.size() };
+
+    ArenaString name1{ arena, "Lebron James" };
+    ArenaString name2{ arena, "Cassandra Wilhelmina Featherstonehaugh" };
+    name2 += " Junior"; // still fits inline
+    printOlder(name1, 39, name2, 41);
+    std::cout << "name2 inline? " << name2.isInline() << '\n';
+
+    const std::vector<std::string_view> parts{ makeParts() };
+    constexpr std::size_t rounds{ 5'000'000 };
+    constexpr std::size_t batchSize{ 4096 };
+    std::size_t checksum{ 0 };
+
+    std::size_t stringAllocs{ 0 };
+    const double stringTime{ timeIt(rounds, [&](std::size_t i) {
+        std::string name{ parts[i % parts.size()] };
+        name += ' ';
+        name += parts[(i / 7) % parts.size()];
+        checksum += name.length();
+    }, stringAllocs) };
+
+    std::size_t arenaAllocs{ 0 };
+    const double arenaTime{ timeIt(rounds, [&](std::size_t i) {
+        if (i % batchSize == 0)
+            arena.reset(); // a batch of names is done with, throw them all away at once
+
+        ArenaString name{ arena, parts[i % parts.size()] };
+        name += " ";
+        name += parts[(i / 7) % parts.size()];
+        checksum += name.length();
+    }, arenaAllocs) };
+
+    std::cout << "checksum: " << checksum << '\n';
+    std::cout << "std::string:  " << rounds / stringTime / 1e6 << " M names/sec, " << stringAllocs << " heap allocations\n";
+    std::cout << "ArenaString:  " << rounds / arenaTime / 1e6 << " M names/sec, " << arenaAllocs << " heap allocations\n";
+
+    return 0;
+}
@@ -0,0 +1,358 @@
+// Streaming version of quiz_q4.cpp.
+// Instead of asking for two people with getName()/getAge(), we read a "name,age" file
+// with (possibly) hundreds of millions of lines and answer in one pass:
+//  - who is the oldest person
+//  - the top k people by age
+//  - how many people fall into each 10-year age bucket
+//
+// The file is memory-mapped, so names stay as std::string_view slices into the mapping
+// (no std::string copies, see std_stringview.cpp). The file is split into one chunk per
+// thread, and every chunk boundary is moved forward to the next '\n' so no line is cut in half.
+//
+// Usage: oldest_stream [--generate] file [k]
+// With --generate, a 10M-row sample file is written to the given path first.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint> // for std::uint32_t
+#include <fstream>
+#include <functional> // for std::ref
+#include <iostream>
+#include <stdexcept> // for std::invalid_argument
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX // otherwise windows.h defines min and max macros that break std::min/std::max
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. Unmaps itself when it goes out of scope.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(m_file, &size))
+            return;
+        m_size = static_cast<std::size_t>(size.QuadPart);
+        if (m_size == 0)
+        {
+            m_ok = true; // an empty file can't be mapped, but it opened fine
+            return;
+        }
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping)
+            m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        m_ok = m_data != nullptr;
+#else
+        m_fd = open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+            return;
+
+        struct stat info{};
+        if (fstat(m_fd, &info) != 0)
+            return;
+        m_size = static_cast<std::size_t>(info.st_size);
+        if (m_size == 0)
+        {
+            m_ok = true; // an empty file can't be mapped, but it opened fine
+            return;
+        }
+
+        void* addr{ mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0) };
+        if (addr == MAP_FAILED)
+            return;
+
+        madvise(addr, m_size, MADV_SEQUENTIAL); // we read front to back, so let the OS read ahead
+        m_data = static_cast<const char*>(addr);
+        m_ok = true;
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+#else
+        if (m_data)
+            munmap(const_cast<char*>(m_data), m_size);
+        if (m_fd >= 0)
+            close(m_fd);
+#endif
+    }
+
+    // Copying would unmap twice, so don't allow it
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return m_ok; }
+    std::string_view contents() const { return m_data ? std::string_view{ m_data, m_size } : std::string_view{}; }
+
+private:
+    const char* m_data{ nullptr };
+    std::size_t m_size{ 0 };
+    bool m_ok{ false }; // opened, and mapped unless it's empty
+#ifdef _WIN32
+    HANDLE m_file{ INVALID_HANDLE_VALUE };
+    HANDLE m_mapping{ nullptr };
+#else
+    int m_fd{ -1 };
+#endif
+};
+
+struct Person
+{
+    std::string_view name{}; // points into the mapped file
+    int age{};
+};
+
+constexpr int bucketWidth{ 10 };
+constexpr int numBuckets{ 13 }; // 0-9, 10-19, ... 110-119, 120+
+
+// Everything one thread finds in its chunk. Results from all threads get merged at the end.
+struct QueryResult
+{
+    Person oldest{ {}, -1 };
+    std::vector<Person> topK{}; // kept as a min-heap on age while scanning
+    std::array<long long, numBuckets> buckets{};
+    long long rows{ 0 };
+    long long badRows{ 0 };
+};
+
+// The heap's top is the youngest of the current top k, so that's the one we replace.
+// Ties are broken on name so the answer doesn't depend on how the file was chunked.
+bool olderThan(const Person& a, const Person& b)
+{
+    return a.age != b.age ? a.age > b.age : a.name < b.name;
+}
+
+void offerTopK(std::vector<Person>& heap, std::size_t k, const Person& person)
+{
+    if (k == 0)
+        return;
+
+    if (heap.size() < k)
+    {
+        heap.push_back(person);
+        std::push_heap(heap.begin(), heap.end(), olderThan);
+    }
+    else if (olderThan(person, heap.front()))
+    {
+        std::pop_heap(heap.begin(), heap.end(), olderThan);
+        heap.back() = person;
+        std::push_heap(heap.begin(), heap.end(), olderThan);
+    }
+}
+
+// Parse one "name,age" line. Returns false if the line is malformed.
+bool parseLine(std::string_view line, Person& person)
+{
+    if (!line.empty() && line.back() == '\r') // Windows line endings
+        line.remove_suffix(1);
+
+    const std::size_t comma{ line.rfind(',') };
+    if (comma == std::string_view::npos || comma + 1 == line.size())
+        return false;
+
+    int age{ 0 };
+    for (char ch : line.substr(comma + 1))
+    {
+        if (ch < '0' || ch > '9' || age > 100'000)
+            return false;
+        age = age * 10 + (ch - '0');
+    }
+
+    person = { line.substr(0, comma), age };
+    return true;
+}
+
+void scanChunk(std::string_view chunk, std::size_t k, QueryResult& result)
+{
+    result.topK.reserve(k);
+
+    while (!chunk.empty())
+    {
+        const std::size_t newline{ chunk.find('\n') };
+        const std::string_view line{ chunk.substr(0, newline) };
+        chunk.remove_prefix(newline == std::string_view::npos ? chunk.size() : newline + 1);
+
+        if (line.empty())
+            continue;
+
+        Person person{};
+        if (!parseLine(line, person))
+        {
+            ++result.badRows;
+            continue;
+        }
+
+        ++result.rows;
+        if (result.oldest.age < 0 || olderThan(person, result.oldest))
+            result.oldest = person;
+        offerTopK(result.topK, k, person);
+        ++result.buckets[static_cast<std::size_t>(std::min(person.age / bucketWidth, numBuckets - 1))];
+    }
+}
+
+// Split text into about numChunks pieces, each ending just after a '\n'
+std::vector<std::string_view> splitAtLines(std::string_view text, std::size_t numChunks)
+{
+    std::vector<std::string_view> chunks{};
+    const std::size_t target{ text.size() / numChunks + 1 };
+
+    while (!text.empty())
+    {
+        std::size_t end{ std::min(target, text.size()) };
+        const std::size_t newline{ text.find('\n', end > 0 ? end - 1 : 0) };
+        end = (newline == std::string_view::npos) ? text.size() : newline + 1;
+
+        chunks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+
+    return chunks;
+}
+
+QueryResult runQueries(std::string_view text, std::size_t k, unsigned int numThreads)
+{
+    const std::vector<std::string_view> chunks{ splitAtLines(text, numThreads) };
+    std::vector<QueryResult> partial(chunks.size());
+
+    std::vector<std::thread> threads{};
+    for (std::size_t i{ 0 }; i < chunks.size(); ++i)
+        threads.emplace_back(scanChunk, chunks[i], k, std::ref(partial[i]));
+    for (std::thread& t : threads)
+        t.join();
+
+    // Merge: everything here is small (k entries and 13 buckets per thread)
+    QueryResult total{};
+    for (const QueryResult& part : partial)
+    {
+        total.rows += part.rows;
+        total.badRows += part.badRows;
+        if (part.oldest.age >= 0 && (total.oldest.age < 0 || olderThan(part.oldest, total.oldest)))
+            total.oldest = part.oldest;
+        for (const Person& person : part.topK)
+            offerTopK(total.topK, k, person);
+        for (std::size_t b{ 0 }; b < total.buckets.size(); ++b)
+            total.buckets[b] += part.buckets[b];
+    }
+
+    std::sort(total.topK.begin(), total.topK.end(), olderThan);
+    return total;
+}
+
+// Same output format as printOlder() in quiz_q4.cpp
+void printOldest(const Person& person)
+{
+    std::cout << person.name << " (age " << person.age << ") is the oldest.\n";
+}
+
+void writeSampleFile(const std::string& path, long long rows)
+{
+    constexpr std::array<std::string_view, 8> names{ "Alex", "Betty", "Chris", "Dana", "Eli", "Fran", "Gus", "Hana" };
+
+    std::ofstream out{ path, std::ios::binary };
+    std::uint32_t state{ 12345 };
+    for (long long i{ 0 }; i < rows; ++i)
+    {
+        state = state * 1664525u + 1013904223u; // cheap LCG, good enough for sample data
+        out << names[state >> 29] << i << ',' << (state >> 8) % 110 << '\n';
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Only write the (~150 MB) sample file when asked to, never as a side effect of a missing argument
+    const bool generate{ argc > 1 && std::string_view{ argv[1] } == "--generate" };
+    const int firstArg{ generate ? 2 : 1 };
+    if (argc <= firstArg || argc > firstArg + 2)
+    {
+        std::cout << "Usage: oldest_stream [--generate] file [k]\n";
+        return 1;
+    }
+    const std::string path{ argv[firstArg] };
+
+    std::size_t k{ 5 };
+    if (argc > firstArg + 1)
+    {
+        const std::string kText{ argv[firstArg + 1] };
+        try
+        {
+            std::size_t used{};
+            k = std::stoul(kText, &used);
+            if (used != kText.size() || kText[0] == '-') // stoul accepts "5x", and wraps "-5" round
+                throw std::invalid_argument{ kText };
+        }
+        catch (const std::exception&) // std::invalid_argument or std::out_of_range
+        {
+            std::cout << "k must be a non-negative whole number, not \"" << kText << "\"\n";
+            return 1;
+        }
+    }
+
+    if (generate)
+    {
+        std::cout << "Writing 10M sample rows to " << path << "...\n";
+        writeSampleFile(path, 10'000'000);
+    }
+
+    const MappedFile file{ path };
+    if (!file.isOpen())
+    {
+        std::cout << "Could not open " << path << '\n';
+        return 1;
+    }
+
+    const unsigned int numThreads{ std::max(1u, std::thread::hardware_concurrency()) };
+
+    const auto start{ std::chrono::steady_clock::now() };
+    const QueryResult result{ runQueries(file.contents(), k, numThreads) };
+    const std::chrono::duration<double> seconds{ std::chrono::steady_clock::now() - start };
+
+    std::cout << result.rows << " rows (" << result.badRows << " malformed) in " << seconds.count() << " s, "
+              << file.contents().size() / seconds.count() / 1e9 << " GB/s on " << numThreads << " thread(s)\n";
+
+    if (result.rows == 0)
+        return 0;
+
+    printOldest(result.oldest);
+
+    std::cout << "Top " << result.topK.size() << " by age:\n";
+    for (const Person& person : result.topK)
+        std::cout << "  " << person.name << " (age " << person.age << ")\n";
+
+    std::cout << "Age buckets:\n";
+    for (int b{ 0 }; b < numBuckets; ++b)
+    {
+        if (b == numBuckets - 1)
+            std::cout << "  " << b * bucketWidth << "+: ";
+        else
+            std::cout << "  " << b * bucketWidth << '-' << b * bucketWidth + bucketWidth - 1 << ": ";
+        std::cout << result.buckets[static_cast<std::size_t>(b)] << '\n';
+    }
+
+    return 0;
+}
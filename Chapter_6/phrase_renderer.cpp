@@ -0,0 +1,177 @@
+// Bulk version of quiz_q1.cpp: instead of stitching every sentence together with
+// several operator<< calls, we render a whole batch of counts straight into one
+// preallocated char buffer. No std::string, no std::ostringstream -> no heap allocations.
+
+#include <algorithm> // for std::clamp, std::max, std::copy_n
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef> // for std::size_t
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+// Same phrases as getQuantityPhrase(), but stored in a table.
+// Index 0 is "negative", index 1 is 0 apples, ... index 5 is "many" (4 or more).
+using PhraseTable = std::array<std::string_view, 6>;
+
+constexpr PhraseTable englishPhrases{ "negative", "no", "a single", "a couple of", "a few", "many" };
+constexpr PhraseTable frenchPhrases{ "moins de", "zero", "une seule", "deux", "quelques", "beaucoup de" };
+
+constexpr std::string_view getQuantityPhrase(const PhraseTable& phrases, int num)
+{
+    // Clamp num into [-1, 4] so it can be used as a table index (no if/else chain)
+    const int index{ std::clamp(num, -1, 4) + 1 };
+    return phrases[static_cast<std::size_t>(index)];
+}
+
+// A noun knows its singular and plural spelling.
+struct Noun
+{
+    std::string_view singular{};
+    std::string_view plural{};
+};
+
+// Pluralization rules are plain function pointers, so the caller can plug in their own.
+// A rule returns true if the singular form should be used for this count.
+using PluralRule = bool (*)(int count);
+
+// English: only exactly 1 is singular ("1 apple", "0 apples")
+constexpr bool englishRule(int count) { return count == 1; }
+
+// French: 0 and 1 are singular ("0 pomme", "2 pommes")
+constexpr bool frenchRule(int count) { return count == 0 || count == 1; }
+
+// Everything in one place: the text before the count, the noun, the rule, and the ending.
+struct MessageTemplate
+{
+    std::string_view prefix{};  // e.g. "Mary has "
+    const PhraseTable* phrases{ &englishPhrases };
+    Noun noun{};
+    PluralRule rule{ englishRule };
+    std::string_view suffix{ ".\n" };
+};
+
+// Writes into a fixed buffer. Never allocates and never writes past the end.
+class BufferWriter
+{
+public:
+    BufferWriter(char* buffer, std::size_t capacity)
+        : m_begin{ buffer }, m_cur{ buffer }, m_end{ buffer + capacity }
+    {
+    }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(m_end - m_cur); }
+    std::size_t size() const { return static_cast<std::size_t>(m_cur - m_begin); }
+
+    // Caller must check remaining() first
+    void append(std::string_view text)
+    {
+        m_cur = std::copy_n(text.data(), text.size(), m_cur);
+    }
+
+    void append(char ch) { *m_cur++ = ch; }
+
+private:
+    char* m_begin{};
+    char* m_cur{};
+    char* m_end{};
+};
+
+// Longest sentence this template can produce, so we can check space once per sentence
+constexpr std::size_t maxSentenceLength(const MessageTemplate& msg)
+{
+    std::size_t longestPhrase{ 0 };
+    for (std::string_view phrase : *msg.phrases)
+        longestPhrase = std::max(longestPhrase, phrase.size());
+
+    return msg.prefix.size() + longestPhrase + 1 + std::max(msg.noun.singular.size(), msg.noun.plural.size()) + msg.suffix.size();
+}
+
+// Render one sentence per count into out.
+// Returns how many sentences were rendered (stops early if the buffer is full,
+// so the caller can flush and call again with the rest of the counts).
+// An empty buffer must have room for maxSentenceLength(msg), or a flush-and-retry loop would never
+// get anywhere.
+std::size_t renderBatch(const MessageTemplate& msg, const int* counts, std::size_t numCounts, BufferWriter& out)
+{
+    const std::size_t worstCase{ maxSentenceLength(msg) };
+    assert((out.size() > 0 || out.remaining() >= worstCase || numCounts == 0) && "buffer too small for one sentence");
+
+    std::size_t rendered{ 0 };
+    for (; rendered < numCounts; ++rendered)
+    {
+        if (out.remaining() < worstCase)
+            break;
+
+        const int count{ counts[rendered] };
+        out.append(msg.prefix);
+        out.append(getQuantityPhrase(*msg.phrases, count));
+        out.append(' ');
+        out.append(msg.rule(count) ? msg.noun.singular : msg.noun.plural);
+        out.append(msg.suffix);
+    }
+
+    return rendered;
+}
+
+// The original way of doing it (quiz_q1.cpp style), used as the benchmark baseline
+std::size_t renderWithStream(const MessageTemplate& msg, const std::vector<int>& counts, std::ostream& out)
+{
+    for (int count : counts)
+        out << msg.prefix << getQuantityPhrase(*msg.phrases, count) << ' ' << (msg.rule(count) ? msg.noun.singular : msg.noun.plural) << msg.suffix;
+
+    return counts.size();
+}
+
+int main()
+{
+    constexpr MessageTemplate english{ "Mary has ", &englishPhrases, { "apple", "apples" }, englishRule, ".\n" };
+    constexpr MessageTemplate french{ "Marie a ", &frenchPhrases, { "pomme", "pommes" }, frenchRule, ".\n" };
+
+    // Small demo that matches quiz_q1.cpp output
+    {
+        std::array<char, 256> buffer{};
+        BufferWriter out{ buffer.data(), buffer.size() };
+
+        constexpr std::array counts{ -2, 0, 1, 2, 3, 4, 42 };
+        renderBatch(english, counts.data(), counts.size(), out);
+        renderBatch(french, counts.data() + 1, 2, out);
+        std::cout << std::string_view{ buffer.data(), out.size() };
+    }
+
+    // Benchmark: sentences per second
+    constexpr std::size_t numSentences{ 5'000'000 };
+    std::vector<int> counts(numSentences);
+    for (std::size_t i{ 0 }; i < numSentences; ++i)
+        counts[i] = static_cast<int>(i % 7) - 1;
+
+    // One 1 MiB buffer, reused for every chunk (like writing a report to a file in chunks)
+    std::vector<char> buffer(1 << 20);
+    std::size_t checksum{ 0 };
+
+    const auto start{ std::chrono::steady_clock::now() };
+    std::size_t done{ 0 };
+    while (done < numSentences)
+    {
+        BufferWriter out{ buffer.data(), buffer.size() };
+        const std::size_t rendered{ renderBatch(english, counts.data() + done, numSentences - done, out) };
+        if (rendered == 0)
+            break; // buffer smaller than one sentence (the assert catches this in debug builds)
+        done += rendered;
+        checksum += out.size(); // pretend we flushed the buffer
+    }
+    const std::chrono::duration<double> tableTime{ std::chrono::steady_clock::now() - start };
+
+    const auto streamStart{ std::chrono::steady_clock::now() };
+    std::ostringstream stream{};
+    renderWithStream(english, counts, stream);
+    const std::chrono::duration<double> streamTime{ std::chrono::steady_clock::now() - streamStart };
+
+    std::cout << "\nbytes rendered: " << checksum << " (stream: " << stream.str().size() << ")\n";
+    std::cout << "table renderer:  " << numSentences / tableTime.count() / 1e6 << " M sentences/sec\n";
+    std::cout << "operator<<:      " << numSentences / streamTime.count() / 1e6 << " M sentences/sec\n";
+
+    return 0;
+}
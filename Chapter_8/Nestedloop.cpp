@@ -0,0 +1,237 @@
+// Nested loops over big 2D arrays: matrix multiply, a 2D stencil, and transpose.
+//
+// Written the obvious way, these get slow fast once the matrices stop fitting in the cache:
+// the inner loop walks down a column, every step lands on a different cache line, and the line
+// is thrown out again before we come back for the next element on it ("falling off a cache cliff").
+//
+// The tiled (cache-blocked) versions work on small square tiles instead, so the data one tile
+// needs stays in the L1/L2 cache while it's being used. The tile size comes from the cache sizes
+// cpu_features.h detects, instead of being a magic number.
+//
+// Usage: Nestedloop [maxSize]   (default 1024; the naive matrix multiply gets slow above that)
+// Build with -O3 -march=native so the contiguous inner loops of the tiled versions get vectorized.
+
+#include <algorithm> // for std::min, std::max
+#include <chrono>
+#include <cmath>     // for std::sqrt, std::abs
+#include <cstddef>
+#include <cstdlib>   // for std::atoi
+#include <iomanip>   // for std::setw
+#include <iostream>
+#include <vector>
+#include "../Chapter_4/cpu_features.h"
+
+// Square n x n matrix stored row by row in one vector (element (row, col) is at row * n + col)
+struct Matrix
+{
+    std::size_t n{};
+    std::vector<double> data{};
+
+    explicit Matrix(std::size_t size)
+        : n{ size }, data(size * size)
+    {
+    }
+
+    double& operator()(std::size_t row, std::size_t col) { return data[row * n + col]; }
+    double operator()(std::size_t row, std::size_t col) const { return data[row * n + col]; }
+};
+
+struct TileSizes
+{
+    std::size_t multiply{};  // three tiles (one of A, B and C) should fit in L2 together
+    std::size_t stencil{};   // columns per strip, so a few rows of the strip fit in L1
+    std::size_t transpose{}; // two tiles (source and destination) should fit in L1 together
+};
+
+// Round down to a multiple of 8 (8 doubles = one 64-byte cache line), at least 8
+std::size_t roundToLine(double size)
+{
+    return std::max<std::size_t>(8, static_cast<std::size_t>(size) / 8 * 8);
+}
+
+TileSizes chooseTileSizes()
+{
+    const CpuFeatures::Features& f{ CpuFeatures::features() };
+    const double l1Doubles{ static_cast<double>(f.l1Cache) / sizeof(double) };
+    const double l2Doubles{ static_cast<double>(f.l2Cache) / sizeof(double) };
+
+    TileSizes tiles{};
+    // Only use about half of each cache, the rest is busy with other things (stack, the other operand, ...)
+    tiles.multiply = roundToLine(std::sqrt(l2Doubles / 2.0 / 3.0));
+    tiles.stencil = roundToLine(l1Doubles / 2.0 / 4.0); // 3 input rows + 1 output row
+    tiles.transpose = roundToLine(std::sqrt(l1Doubles / 2.0 / 2.0));
+    return tiles;
+}
+
+// ---- Matrix multiply: C = A * B ----
+
+void multiplyNaive(const Matrix& a, const Matrix& b, Matrix& c)
+{
+    const std::size_t n{ a.n };
+    for (std::size_t i{ 0 }; i < n; ++i)
+    {
+        for (std::size_t j{ 0 }; j < n; ++j)
+        {
+            double sum{ 0.0 };
+            for (std::size_t k{ 0 }; k < n; ++k)
+                sum += a(i, k) * b(k, j); // b(k, j) walks down a column: a new cache line every step
+            c(i, j) = sum;
+        }
+    }
+}
+
+void multiplyTiled(const Matrix& a, const Matrix& b, Matrix& c, std::size_t tile)
+{
+    const std::size_t n{ a.n };
+    std::fill(c.data.begin(), c.data.end(), 0.0);
+
+    for (std::size_t ii{ 0 }; ii < n; ii += tile)
+    {
+        for (std::size_t kk{ 0 }; kk < n; kk += tile)
+        {
+            for (std::size_t jj{ 0 }; jj < n; jj += tile)
+            {
+                const std::size_t iEnd{ std::min(ii + tile, n) };
+                const std::size_t kEnd{ std::min(kk + tile, n) };
+                const std::size_t jEnd{ std::min(jj + tile, n) };
+
+                // Inside one tile, loop order i-k-j: the innermost loop walks along rows of B and C,
+                // which is contiguous memory and vectorizes
+                for (std::size_t i{ ii }; i < iEnd; ++i)
+                {
+                    for (std::size_t k{ kk }; k < kEnd; ++k)
+                    {
+                        const double aik{ a(i, k) };
+                        double* cRow{ &c.data[i * n] };
+                        const double* bRow{ &b.data[k * n] };
+                        for (std::size_t j{ jj }; j < jEnd; ++j)
+                            cRow[j] += aik * bRow[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ---- 2D stencil: each interior point becomes the average of itself and its 4 neighbours ----
+// The naive version goes column by column (the "wrong" loop order someone might write
+// for a column-major mental picture); the tiled one sweeps rows inside narrow column strips.
+
+void stencilNaive(const Matrix& in, Matrix& out)
+{
+    const std::size_t n{ in.n };
+    for (std::size_t col{ 1 }; col + 1 < n; ++col)
+        for (std::size_t row{ 1 }; row + 1 < n; ++row)
+            out(row, col) = 0.2 * (in(row, col) + in(row - 1, col) + in(row + 1, col) + in(row, col - 1) + in(row, col + 1));
+}
+
+void stencilTiled(const Matrix& in, Matrix& out, std::size_t strip)
+{
+    const std::size_t n{ in.n };
+    for (std::size_t colStart{ 1 }; colStart + 1 < n; colStart += strip)
+    {
+        const std::size_t colEnd{ std::min(colStart + strip, n - 1) };
+        for (std::size_t row{ 1 }; row + 1 < n; ++row)
+        {
+            const double* above{ &in.data[(row - 1) * n] };
+            const double* here{ &in.data[row * n] };
+            const double* below{ &in.data[(row + 1) * n] };
+            double* result{ &out.data[row * n] };
+            for (std::size_t col{ colStart }; col < colEnd; ++col)
+                result[col] = 0.2 * (here[col] + above[col] + below[col] + here[col - 1] + here[col + 1]);
+        }
+    }
+}
+
+// ---- Transpose: out(j, i) = in(i, j) ----
+
+void transposeNaive(const Matrix& in, Matrix& out)
+{
+    const std::size_t n{ in.n };
+    for (std::size_t i{ 0 }; i < n; ++i)
+        for (std::size_t j{ 0 }; j < n; ++j)
+            out(j, i) = in(i, j); // writes walk down a column
+}
+
+void transposeTiled(const Matrix& in, Matrix& out, std::size_t tile)
+{
+    const std::size_t n{ in.n };
+    for (std::size_t ii{ 0 }; ii < n; ii += tile)
+        for (std::size_t jj{ 0 }; jj < n; jj += tile)
+            for (std::size_t i{ ii }; i < std::min(ii + tile, n); ++i)
+                for (std::size_t j{ jj }; j < std::min(jj + tile, n); ++j)
+                    out(j, i) = in(i, j);
+}
+
+// ---- Benchmark ----
+
+template <typename Fn>
+double seconds(Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    fn();
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    return elapsed.count();
+}
+
+double maxDifference(const Matrix& x, const Matrix& y)
+{
+    double diff{ 0.0 };
+    for (std::size_t i{ 0 }; i < x.data.size(); ++i)
+        diff = std::max(diff, std::abs(x.data[i] - y.data[i]));
+    return diff;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t maxSize{ argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : 1024 };
+    const TileSizes tiles{ chooseTileSizes() };
+    const CpuFeatures::Features& f{ CpuFeatures::features() };
+
+    std::cout << "L1 " << f.l1Cache / 1024 << " KiB, L2 " << f.l2Cache / 1024 << " KiB -> tiles: multiply " << tiles.multiply
+              << ", stencil strip " << tiles.stencil << ", transpose " << tiles.transpose << "\n\n";
+
+    std::cout << std::setw(6) << "n" << std::setw(16) << "matmul naive" << std::setw(16) << "matmul tiled"
+              << std::setw(16) << "stencil naive" << std::setw(16) << "stencil tiled"
+              << std::setw(18) << "transpose naive" << std::setw(18) << "transpose tiled" << '\n';
+    std::cout << std::setw(6) << "" << std::setw(16) << "GFLOP/s" << std::setw(16) << "GFLOP/s" << std::setw(16) << "GFLOP/s"
+              << std::setw(16) << "GFLOP/s" << std::setw(18) << "GB/s" << std::setw(18) << "GB/s" << '\n';
+
+    // Sizes a little over powers of two: exact powers of two make the naive versions look even
+    // worse, because every element of a column maps to the same few cache sets
+    for (std::size_t n{ 128 }; n <= maxSize; n *= 2)
+    {
+        const std::size_t size{ n + 8 };
+        Matrix a{ size };
+        Matrix b{ size };
+        for (std::size_t i{ 0 }; i < a.data.size(); ++i)
+        {
+            a.data[i] = static_cast<double>(i % 17) * 0.5;
+            b.data[i] = static_cast<double>(i % 13) - 6.0;
+        }
+        Matrix c1{ size };
+        Matrix c2{ size };
+
+        const double flops{ 2.0 * size * size * size };
+        const double mulNaive{ flops / seconds([&] { multiplyNaive(a, b, c1); }) / 1e9 };
+        const double mulTiled{ flops / seconds([&] { multiplyTiled(a, b, c2, tiles.multiply); }) / 1e9 };
+        const bool mulOk{ maxDifference(c1, c2) < 1e-6 * static_cast<double>(size) };
+
+        constexpr int sweeps{ 10 };
+        const double stencilFlops{ 5.0 * (size - 2) * (size - 2) * sweeps };
+        const double stNaive{ stencilFlops / seconds([&] { for (int s{ 0 }; s < sweeps; ++s) stencilNaive(a, c1); }) / 1e9 };
+        const double stTiled{ stencilFlops / seconds([&] { for (int s{ 0 }; s < sweeps; ++s) stencilTiled(a, c2, tiles.stencil); }) / 1e9 };
+        const bool stOk{ maxDifference(c1, c2) == 0.0 };
+
+        const double bytes{ 2.0 * sizeof(double) * size * size * sweeps };
+        const double trNaive{ bytes / seconds([&] { for (int s{ 0 }; s < sweeps; ++s) transposeNaive(a, c1); }) / 1e9 };
+        const double trTiled{ bytes / seconds([&] { for (int s{ 0 }; s < sweeps; ++s) transposeTiled(a, c2, tiles.transpose); }) / 1e9 };
+        const bool trOk{ maxDifference(c1, c2) == 0.0 };
+
+        std::cout << std::setw(6) << size << std::setw(16) << mulNaive << std::setw(16) << mulTiled << std::setw(16) << stNaive
+                  << std::setw(16) << stTiled << std::setw(18) << trNaive << std::setw(18) << trTiled
+                  << (mulOk && stOk && trOk ? "" : "  MISMATCH!") << '\n';
+    }
+
+    return 0;
+}
@@ -1,8 +1,21 @@
 #ifndef RANDOM_MT_H
 #define RANDOM_MT_H
 
+#include <algorithm> // for std::min
+#include <array>
 #include <chrono>
+#include <cmath>   // for std::log, std::exp, std::floor, std::sqrt, std::abs, std::isfinite
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy
+#include <iterator> // for std::iterator_traits
+#include <numeric>  // for std::iota
 #include <random>
+#include <stdexcept> // for std::invalid_argument
+#include <type_traits> // for std::is_same_v
+#include <unordered_set>
+#include <utility>  // for std::swap, std::move
+#include <vector>
 
 // This header-only Random namespace implements a self-seeding Mersenne Twister.
 // Requires C++17 or newer.
@@ -67,6 +80,480 @@ namespace Random
 	{
 		return get<R>(static_cast<R>(min), static_cast<R>(max));
 	}
+
+	// ---- Shuffling and sampling ----
+	// These take the engine as an optional last argument (default: our global mt),
+	// so a benchmark or test can pass its own seeded std::mt19937 and get repeatable results.
+
+	// Random integer in [0, range) without the bias of "mt() % range", and almost never dividing.
+	// (Lemire's method: the top 32 bits of mt() * range are the answer; only when the bottom 32 bits
+	// land in a small unfair zone do we compute the zone's exact size and maybe draw again.)
+	// range must be at least 1.
+	inline std::uint32_t bounded(std::uint32_t range, std::mt19937& engine = mt)
+	{
+		std::uint64_t m{ static_cast<std::uint64_t>(engine()) * range };
+		std::uint32_t low{ static_cast<std::uint32_t>(m) };
+		if (low < range)
+		{
+			const std::uint32_t threshold{ (0u - range) % range }; // 2^32 mod range
+			while (low < threshold)
+			{
+				m = static_cast<std::uint64_t>(engine()) * range;
+				low = static_cast<std::uint32_t>(m);
+			}
+		}
+		return static_cast<std::uint32_t>(m >> 32);
+	}
+
+	// Random integer in [0, range) for any std::size_t range (at least 1). Ranges that fit in 32 bits
+	// go to bounded(); bigger ones (only arrays of over 4 billion elements) draw 64 bits, keep as many
+	// as range needs, and draw again if the result is too big (less than half the time).
+	inline std::size_t boundedIndex(std::size_t range, std::mt19937& engine = mt)
+	{
+		if (range <= 0xFFFFFFFFu)
+			return bounded(static_cast<std::uint32_t>(range), engine);
+		const std::uint64_t last{ static_cast<std::uint64_t>(range) - 1 };
+		const std::uint64_t mask{ ~std::uint64_t{ 0 } >> __builtin_clzll(last) };
+		while (true)
+		{
+			const std::uint64_t draw{ ((static_cast<std::uint64_t>(engine()) << 32) | engine()) & mask };
+			if (draw <= last)
+				return static_cast<std::size_t>(draw);
+		}
+	}
+
+	// Two random integers, in [0, range1) and [0, range2), from a single mt() call.
+	// Only valid when range1 * range2 <= 2^32 (the same trick as bounded(), applied twice in a row).
+	inline std::pair<std::uint32_t, std::uint32_t> boundedPair(std::uint32_t range1, std::uint32_t range2, std::mt19937& engine = mt)
+	{
+		const std::uint64_t product{ static_cast<std::uint64_t>(range1) * range2 };
+		while (true)
+		{
+			std::uint64_t m1{ static_cast<std::uint64_t>(engine()) * range1 };
+			std::uint64_t m2{ (m1 & 0xFFFFFFFFu) * range2 };
+			if ((m2 & 0xFFFFFFFFu) >= product)
+				return { static_cast<std::uint32_t>(m1 >> 32), static_cast<std::uint32_t>(m2 >> 32) };
+
+			// Rare: maybe in the unfair zone, check exactly (2^32 mod product)
+			const std::uint64_t threshold{ ((std::uint64_t{ 1 } << 32) - product) % product };
+			if ((m2 & 0xFFFFFFFFu) >= threshold)
+				return { static_cast<std::uint32_t>(m1 >> 32), static_cast<std::uint32_t>(m2 >> 32) };
+		}
+	}
+
+	// Shuffle [first, last) into a uniformly random order (Fisher-Yates).
+	// While the remaining part is small enough (up to 65536 elements), each mt() call gives two swap positions.
+	template <typename RandomIt>
+	void shuffle(RandomIt first, RandomIt last, std::mt19937& engine = mt)
+	{
+		using std::swap;
+		std::size_t i{ static_cast<std::size_t>(last - first) };
+
+		// Big arrays: one random number per position
+		for (; i > (1u << 16); --i)
+			swap(first[i - 1], first[boundedIndex(i, engine)]);
+
+		// i * (i - 1) <= 2^32 from here on: two positions per random number
+		for (; i > 2; i -= 2)
+		{
+			const auto [j1, j2] { boundedPair(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(i - 1), engine) };
+			swap(first[i - 1], first[j1]);
+			swap(first[i - 2], first[j2]);
+		}
+		if (i == 2)
+			swap(first[1], first[bounded(2, engine)]);
+	}
+
+	// k different indices from [0, n), in random order. If k >= n, all n of them.
+	inline std::vector<std::size_t> sampleIndices(std::size_t n, std::size_t k, std::mt19937& engine = mt)
+	{
+		k = std::min(k, n);
+		std::vector<std::size_t> result{};
+		result.reserve(k);
+
+		if (k > n / 8)
+		{
+			// A good part of the range: shuffle just the first k positions of 0, 1, ..., n - 1
+			std::vector<std::size_t> all(n);
+			std::iota(all.begin(), all.end(), std::size_t{ 0 });
+			for (std::size_t i{ 0 }; i < k; ++i)
+				std::swap(all[i], all[i + boundedIndex(n - i, engine)]);
+			all.resize(k);
+			return all;
+		}
+
+		// A small part: Floyd's algorithm, k random numbers and a set of k, no matter how big n is
+		std::unordered_set<std::size_t> chosen{};
+		chosen.reserve(k);
+		for (std::size_t j{ n - k }; j < n; ++j)
+		{
+			const std::size_t t{ boundedIndex(j + 1, engine) };
+			const std::size_t pick{ chosen.insert(t).second ? t : j }; // t taken already? then j is new for sure
+			if (pick == j)
+				chosen.insert(j);
+			result.push_back(pick);
+		}
+		shuffle(result.begin(), result.end(), engine); // Floyd's order isn't random, so mix it
+		return result;
+	}
+
+	// k different elements of [first, last) (different positions, that is), in random order
+	template <typename RandomIt>
+	std::vector<typename std::iterator_traits<RandomIt>::value_type> sample(RandomIt first, RandomIt last, std::size_t k, std::mt19937& engine = mt)
+	{
+		std::vector<typename std::iterator_traits<RandomIt>::value_type> result{};
+		for (std::size_t index : sampleIndices(static_cast<std::size_t>(last - first), k, engine))
+			result.push_back(first[index]);
+		return result;
+	}
+
+	// ---- Floating point ----
+
+	// 64 random bits from two mt() calls
+	inline std::uint64_t bits64(std::mt19937& engine = mt)
+	{
+		return (static_cast<std::uint64_t>(engine()) << 32) | engine();
+	}
+
+	// Random float or double in [0, 1), straight from the engine's bits.
+	// The trick: put random bits into the fraction of a number whose exponent makes it fall in
+	// [1, 2), then subtract 1. No division and no std::generate_canonical loop.
+	// float uses one mt() call (23 random bits), double uses two (52 random bits).
+	template <typename T = double>
+	T uniform01(std::mt19937& engine = mt)
+	{
+		static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "uniform01 makes float or double");
+		if constexpr (std::is_same_v<T, float>)
+		{
+			const std::uint32_t bits{ 0x3F800000u | (static_cast<std::uint32_t>(engine()) >> 9) }; // exponent of 1.0f, 23 fraction bits
+			float oneToTwo{};
+			std::memcpy(&oneToTwo, &bits, sizeof(bits));
+			return oneToTwo - 1.0f;
+		}
+		else
+		{
+			const std::uint64_t bits{ 0x3FF0000000000000ull | (bits64(engine) >> 12) }; // exponent of 1.0, 52 fraction bits
+			double oneToTwo{};
+			std::memcpy(&oneToTwo, &bits, sizeof(bits));
+			return oneToTwo - 1.0;
+		}
+	}
+
+	// Keeps a uniform random sample of k items from a stream of unknown length, seen one at a time.
+	// Instead of drawing a random number for every item (Algorithm R), it works out how many items
+	// to skip before the next one that gets in (Li's Algorithm L), so a long stream costs only
+	// about k * log(n / k) random numbers.
+	template <typename T>
+	class Reservoir
+	{
+	public:
+		explicit Reservoir(std::size_t k, std::mt19937& engine = mt)
+			: m_k{ k }, m_engine{ engine }
+		{
+			m_items.reserve(k);
+		}
+
+		void add(const T& item)
+		{
+			if (m_k == 0)
+			{
+				++m_seen; // nothing is ever kept
+				return;
+			}
+			if (m_items.size() < m_k)
+			{
+				m_items.push_back(item);
+				if (m_items.size() == m_k)
+					scheduleNext();
+			}
+			else if (m_seen == m_next)
+			{
+				m_items[boundedIndex(m_k, m_engine)] = item;
+				scheduleNext();
+			}
+			++m_seen;
+		}
+
+		const std::vector<T>& items() const { return m_items; }
+		std::size_t seen() const { return m_seen; }
+
+	private:
+		// 1 - u can't be 0, so the logs below stay finite
+		double openUnit() { return 1.0 - uniform01<double>(m_engine); }
+
+		void scheduleNext()
+		{
+			if (m_k == 0)
+				return;
+			if (m_w == 0.0)
+				m_w = std::exp(std::log(openUnit()) / static_cast<double>(m_k));
+			m_next = m_seen + 1 + static_cast<std::size_t>(std::floor(std::log(openUnit()) / std::log(1.0 - m_w)));
+			m_w *= std::exp(std::log(openUnit()) / static_cast<double>(m_k));
+		}
+
+		std::size_t m_k{};
+		std::mt19937& m_engine;
+		std::vector<T> m_items{};
+		std::size_t m_seen{ 0 };
+		std::size_t m_next{ 0 };
+		double m_w{ 0.0 };
+	};
+
+	// Picks index i with probability weights[i] / (sum of weights), in constant time per draw no
+	// matter how many weights there are (Walker's alias method, built with Vose's algorithm).
+	// Each of the n columns holds at most two outcomes: its own, or an "alias". A draw picks a column
+	// and then flips a biased coin between the two.
+	class WeightedSampler
+	{
+	public:
+		// Throws std::invalid_argument unless there's at least one weight, none is negative (or NaN),
+		// and they add up to a positive, finite total
+		explicit WeightedSampler(const std::vector<double>& weights)
+			: m_threshold(weights.size()), m_alias(weights.size())
+		{
+			const std::size_t n{ weights.size() };
+			if (n == 0 || n > 0xFFFFFFFFu)
+				throw std::invalid_argument{ "WeightedSampler needs between 1 and 2^32 - 1 weights" };
+			double total{ 0.0 };
+			for (double w : weights)
+			{
+				if (!(w >= 0.0))
+					throw std::invalid_argument{ "WeightedSampler weights can't be negative or NaN" };
+				total += w;
+			}
+			if (!(total > 0.0) || !std::isfinite(total))
+				throw std::invalid_argument{ "WeightedSampler weights must add up to a positive, finite total" };
+
+			// Scale so the average column is exactly 1, then pair up short columns with tall ones
+			std::vector<double> scaled(n);
+			std::vector<std::uint32_t> small{};
+			std::vector<std::uint32_t> large{};
+			for (std::size_t i{ 0 }; i < n; ++i)
+			{
+				scaled[i] = weights[i] * static_cast<double>(n) / total;
+				(scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+			}
+			while (!small.empty() && !large.empty())
+			{
+				const std::uint32_t s{ small.back() };
+				const std::uint32_t l{ large.back() };
+				small.pop_back();
+				setColumn(s, scaled[s], l);
+				scaled[l] -= 1.0 - scaled[s]; // l gives away what s was missing
+				if (scaled[l] < 1.0)
+				{
+					large.pop_back();
+					small.push_back(l);
+				}
+			}
+			// Whatever is left is 1 up to rounding error
+			for (std::uint32_t i : small)
+				setColumn(i, 1.0, i);
+			for (std::uint32_t i : large)
+				setColumn(i, 1.0, i);
+		}
+
+		std::size_t size() const { return m_alias.size(); }
+
+		std::size_t operator()(std::mt19937& engine = mt) const
+		{
+			const std::uint32_t column{ bounded(static_cast<std::uint32_t>(m_alias.size()), engine) };
+			// The coin is compared as integers: threshold is the column's own share scaled to 2^32
+			return engine() < m_threshold[column] ? column : m_alias[column];
+		}
+
+		// Fill [first, last) with draws
+		template <typename OutputIt>
+		void fill(OutputIt first, OutputIt last, std::mt19937& engine = mt) const
+		{
+			for (; first != last; ++first)
+				*first = (*this)(engine);
+		}
+
+	private:
+		void setColumn(std::uint32_t column, double ownShare, std::uint32_t alias)
+		{
+			// A share of 1 must always win the coin flip, and engine() can be up to 2^32 - 1
+			const double scaled{ ownShare * 4294967296.0 };
+			m_threshold[column] = scaled >= 4294967295.0 ? 0xFFFFFFFFu : static_cast<std::uint32_t>(scaled);
+			m_alias[column] = ownShare >= 1.0 ? column : alias;
+		}
+
+		std::vector<std::uint32_t> m_threshold{};
+		std::vector<std::uint32_t> m_alias{};
+	};
+
+	// ---- Normal and exponential draws: the ziggurat method ----
+	// The area under the curve is covered by a stack of equal-area rectangles (the "ziggurat").
+	// Pick a rectangle at random, then a random point in it: almost always (about 99% of the time)
+	// the point is safely inside the curve and we're done with one multiply and one compare, no
+	// log, exp or sqrt. Only the thin slivers at the rectangles' edges and the far tail need more work.
+	// (Marsaglia and Tsang's method, arranged as in Doornik's ZIGNOR so the rectangle index and the
+	// point inside it come from different random bits.)
+
+	namespace detail
+	{
+		// x[i] is the right edge of rectangle i (x[0] is a "virtual" edge for the bottom one, which also
+		// holds the tail). ratio[i] = x[i + 1] / x[i]: points left of that are always under the curve.
+		template <std::size_t Layers>
+		struct Ziggurat
+		{
+			std::array<double, Layers + 1> x{};
+			std::array<double, Layers> ratio{};
+		};
+
+		// f is the (unnormalized) density, inverse its inverse, r the start of the tail and v each rectangle's area
+		template <std::size_t Layers, typename F, typename Inverse>
+		Ziggurat<Layers> makeZiggurat(double r, double v, F f, Inverse inverse)
+		{
+			Ziggurat<Layers> z{};
+			z.x[0] = v / f(r);
+			z.x[1] = r;
+			for (std::size_t i{ 2 }; i < Layers; ++i)
+				z.x[i] = inverse(v / z.x[i - 1] + f(z.x[i - 1]));
+			z.x[Layers] = 0.0;
+			for (std::size_t i{ 0 }; i < Layers; ++i)
+				z.ratio[i] = z.x[i + 1] / z.x[i];
+			return z;
+		}
+
+		inline const Ziggurat<128> normalZiggurat{ makeZiggurat<128>(
+			3.442619855899, 9.91256303526217e-3,
+			[](double x) { return std::exp(-0.5 * x * x); },
+			[](double y) { return std::sqrt(-2.0 * std::log(y)); }) };
+
+		inline const Ziggurat<256> exponentialZiggurat{ makeZiggurat<256>(
+			7.69711747013104972, 3.949659822581572e-3,
+			[](double x) { return std::exp(-x); },
+			[](double y) { return -std::log(y); }) };
+
+		// Uniform in (0, 1], safe to take the log of
+		inline double openUnit(std::mt19937& engine) { return 1.0 - uniform01<double>(engine); }
+	}
+
+	// Standard normal (mean 0, standard deviation 1).
+	// double uses two mt() calls per try: 7 bits pick the rectangle, 52 others place the point.
+	// float uses one: 7 bits and 24 bits.
+	template <typename T = double>
+	T normal(std::mt19937& engine = mt)
+	{
+		static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "normal makes float or double");
+		const detail::Ziggurat<128>& z{ detail::normalZiggurat };
+		while (true)
+		{
+			double u{};        // in [-1, 1)
+			std::size_t i{};   // which rectangle
+			if constexpr (std::is_same_v<T, float>)
+			{
+				const std::uint32_t r{ static_cast<std::uint32_t>(engine()) };
+				i = r & 0x7F;
+				u = static_cast<double>(static_cast<std::int32_t>(r & 0xFFFFFF00u)) * 0x1.0p-31;
+			}
+			else
+			{
+				const std::uint64_t r{ bits64(engine) };
+				i = r & 0x7F;
+				u = static_cast<double>(static_cast<std::int64_t>(r & ~std::uint64_t{ 0x7FF })) * 0x1.0p-63;
+			}
+
+			if (std::abs(u) < z.ratio[i])
+				return static_cast<T>(u * z.x[i]); // the fast path
+
+			if (i == 0)
+			{
+				// The tail beyond r: Marsaglia's method draws from it exactly
+				const double r{ z.x[1] };
+				double x{};
+				double y{};
+				do
+				{
+					x = std::log(detail::openUnit(engine)) / r;
+					y = std::log(detail::openUnit(engine));
+				} while (-2.0 * y < x * x);
+				return static_cast<T>(u < 0.0 ? x - r : r - x);
+			}
+
+			// In the sliver at the edge of rectangle i: accept if under the curve
+			const double x{ u * z.x[i] };
+			const double f0{ std::exp(-0.5 * (z.x[i] * z.x[i] - x * x)) };
+			const double f1{ std::exp(-0.5 * (z.x[i + 1] * z.x[i + 1] - x * x)) };
+			if (f1 + uniform01<double>(engine) * (f0 - f1) < 1.0)
+				return static_cast<T>(x);
+		}
+	}
+
+	template <typename T>
+	T normal(T mean, T stddev, std::mt19937& engine = mt)
+	{
+		return mean + stddev * normal<T>(engine);
+	}
+
+	// Exponential with rate 1 (mean 1). Same idea as normal(), with 256 rectangles.
+	template <typename T = double>
+	T exponential(std::mt19937& engine = mt)
+	{
+		static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "exponential makes float or double");
+		const detail::Ziggurat<256>& z{ detail::exponentialZiggurat };
+		while (true)
+		{
+			double u{};        // in [0, 1)
+			std::size_t i{};
+			if constexpr (std::is_same_v<T, float>)
+			{
+				const std::uint32_t r{ static_cast<std::uint32_t>(engine()) };
+				i = r & 0xFF;
+				u = static_cast<double>(r >> 8) * 0x1.0p-24;
+			}
+			else
+			{
+				const std::uint64_t r{ bits64(engine) };
+				i = r & 0xFF;
+				u = static_cast<double>(r >> 11) * 0x1.0p-53;
+			}
+
+			if (u < z.ratio[i])
+				return static_cast<T>(u * z.x[i]);
+
+			if (i == 0) // past r, the tail is just r plus another exponential ("memoryless")
+				return static_cast<T>(z.x[1] - std::log(detail::openUnit(engine)));
+
+			const double x{ u * z.x[i] };
+			const double f0{ std::exp(x - z.x[i]) };
+			const double f1{ std::exp(x - z.x[i + 1]) };
+			if (f1 + uniform01<double>(engine) * (f0 - f1) < 1.0)
+				return static_cast<T>(x);
+		}
+	}
+
+	template <typename T>
+	T exponential(T rate, std::mt19937& engine = mt)
+	{
+		return exponential<T>(engine) / rate;
+	}
+
+	// Batch versions: fill a whole range at once. The element type decides float or double.
+	template <typename ForwardIt>
+	void fillUniform01(ForwardIt first, ForwardIt last, std::mt19937& engine = mt)
+	{
+		using T = typename std::iterator_traits<ForwardIt>::value_type;
+		for (; first != last; ++first)
+			*first = uniform01<T>(engine);
+	}
+
+	template <typename ForwardIt, typename T = typename std::iterator_traits<ForwardIt>::value_type>
+	void fillNormal(ForwardIt first, ForwardIt last, T mean = T{ 0 }, T stddev = T{ 1 }, std::mt19937& engine = mt)
+	{
+		for (; first != last; ++first)
+			*first = mean + stddev * normal<T>(engine);
+	}
+
+	template <typename ForwardIt, typename T = typename std::iterator_traits<ForwardIt>::value_type>
+	void fillExponential(ForwardIt first, ForwardIt last, T rate = T{ 1 }, std::mt19937& engine = mt)
+	{
+		const T scale{ T{ 1 } / rate };
+		for (; first != last; ++first)
+			*first = exponential<T>(engine) * scale;
+	}
 }
 
 #endif
\ No newline at end of file
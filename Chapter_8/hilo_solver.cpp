@@ -0,0 +1,458 @@
+// quiz_q3_HiLo-Game.cpp lets a person play Hi-Lo. This works out how to play it perfectly: for a
+// range, a guess limit and a prior (how likely each number is to be the secret one), which guess
+// to make next, and the best possible chance of winning or expected leaderboard score.
+//
+// Any way of playing is a binary search tree: the root is the first guess, "too high" goes to the
+// left child, "too low" to the right one. The numbers you can win on are exactly the guesses in
+// the first guessLimit levels, and that's at most 2^guessLimit - 1 numbers.
+//
+// IntervalSolver is the general answer. best(low, high, g) = the most you can expect from a secret
+// somewhere in low..high with g guesses left. Try every guess k in the range:
+//     reward(k found now) * p[k] + best(low, k - 1, g - 1) + best(k + 1, high, g - 1)
+// and keep the best one. That's O(n^2) ranges times O(n) guesses per guess count, so it's for
+// ranges up to a few hundred or thousand numbers. The reward can be anything that doesn't grow
+// with the guess number: always 1 gives the win probability, Leaderboard::hiLoScore() the score.
+//
+// For the win probability there's a shortcut that works for any n: ANY set of at most
+// 2^guessLimit - 1 numbers can be the guesses of a tree that deep (guess the middle one of the
+// set that's still possible, and each half has at most 2^(guessLimit-1) - 1 left). So the best
+// chance of winning is simply the total probability of the 2^guessLimit - 1 likeliest numbers,
+// and TopSetSolver finds those with one std::nth_element: O(n), fine for ranges of 1e6 and more.
+// With a uniform prior that's min(n, 2^guessLimit - 1) / n, and the best expected score has a
+// closed form too (uniformBest()): always guessing the middle fills the tree level by level.
+// main() checks both shortcuts against IntervalSolver.
+//
+// Build with -O2 -pthread.
+
+#include <algorithm> // for std::max, std::min, std::nth_element, std::sort, std::lower_bound
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip> // for std::setw, std::setprecision
+#include <iostream>
+#include <numeric> // for std::iota
+#include <random>
+#include <thread>
+#include <vector>
+#include "leaderboard.h" // for Leaderboard::hiLoScore
+
+// rewards[d] is what finding the secret on guess d (1-based) is worth; rewards[0] is unused
+std::vector<double> winRewards(int guessLimit)
+{
+    std::vector<double> rewards(static_cast<std::size_t>(guessLimit) + 1, 1.0);
+    rewards[0] = 0.0;
+    return rewards;
+}
+
+std::vector<double> scoreRewards(int guessLimit)
+{
+    std::vector<double> rewards(static_cast<std::size_t>(guessLimit) + 1, 0.0);
+    for (int d{ 1 }; d <= guessLimit; ++d)
+        rewards[static_cast<std::size_t>(d)] = Leaderboard::hiLoScore(true, d, guessLimit);
+    return rewards;
+}
+
+// Calls fn(t) for t = 0 .. threads - 1, each on its own thread, and waits for them
+template <typename Fn>
+void parallelFor(unsigned threads, Fn fn)
+{
+    std::vector<std::thread> workers{};
+    for (unsigned t{ 1 }; t < threads; ++t)
+        workers.emplace_back(fn, t);
+    fn(0u);
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+// ----------------------------------------------------------------------------------------------
+
+class IntervalSolver
+{
+public:
+    // prior[i] is the chance that the secret is min + i. threads = 0 means one per core.
+    IntervalSolver(const std::vector<double>& prior, const std::vector<double>& rewards, unsigned threads = 0)
+        : m_n{ static_cast<int>(prior.size()) }, m_limit{ static_cast<int>(rewards.size()) - 1 }
+    {
+        const std::size_t n{ prior.size() };
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        m_choice.resize(static_cast<std::size_t>(m_limit) * n * n);
+
+        // best(low, high) with one guess fewer, stored twice: by [low][high] and by [high][low], so
+        // that both halves of every split are read from consecutive memory in the loop over k
+        std::vector<double> prevByLow(n * n, 0.0);
+        std::vector<double> prevByHigh(n * n, 0.0);
+        std::vector<double> curByLow(n * n, 0.0);
+        std::vector<double> curByHigh(n * n, 0.0);
+
+        for (int g{ 1 }; g <= m_limit; ++g)
+        {
+            // Found with g guesses left means found on guess number limit - g + 1
+            const double reward{ rewards[static_cast<std::size_t>(m_limit - g + 1)] };
+            std::uint16_t* choice{ &m_choice[static_cast<std::size_t>(g - 1) * n * n] };
+
+            // With g guesses left every range depends only on ranges with g - 1 left, so all of them
+            // (every size) can be solved at once. Threads take every threads-th low end, which mixes
+            // long and short ranges evenly.
+            parallelFor(threads, [&](unsigned t) {
+                for (std::size_t low{ t }; low < n; low += threads)
+                {
+                    for (std::size_t high{ low }; high < n; ++high)
+                    {
+                        double best{ -1.0 };
+                        std::size_t bestK{ low };
+                        for (std::size_t k{ low }; k <= high; ++k)
+                        {
+                            const double left{ k > low ? prevByLow[low * n + k - 1] : 0.0 };
+                            const double right{ k < high ? prevByHigh[high * n + k + 1] : 0.0 };
+                            const double value{ reward * prior[k] + left + right };
+                            if (value > best)
+                            {
+                                best = value;
+                                bestK = k;
+                            }
+                        }
+                        curByLow[low * n + high] = best;
+                        curByHigh[high * n + low] = best;
+                        choice[low * n + high] = static_cast<std::uint16_t>(bestK - low);
+                    }
+                }
+            });
+            std::swap(prevByLow, curByLow);
+            std::swap(prevByHigh, curByHigh);
+        }
+        m_best = n == 0 ? 0.0 : prevByLow[n - 1];
+        m_tableBytes = 4 * n * n * sizeof(double);
+    }
+
+    // Win probability or expected score (whatever the rewards add up to), playing perfectly
+    double best() const { return m_best; }
+
+    // The guess to make when the secret is known to be in low..high (indices into the prior)
+    int bestGuess(int low, int high, int guessesLeft) const
+    {
+        const std::size_t n{ static_cast<std::size_t>(m_n) };
+        const std::size_t g{ static_cast<std::size_t>(std::clamp(guessesLeft, 1, m_limit)) };
+        return low + m_choice[(g - 1) * n * n + static_cast<std::size_t>(low) * n + static_cast<std::size_t>(high)];
+    }
+
+    // The policy, plus the largest the working tables got
+    std::size_t memoryBytes() const { return m_choice.size() * sizeof(std::uint16_t) + m_tableBytes; }
+
+private:
+    int m_n{};
+    int m_limit{};
+    double m_best{};
+    std::vector<std::uint16_t> m_choice{}; // [guesses left - 1][low][high]: best guess - low (so n <= 65536)
+    std::size_t m_tableBytes{};
+};
+
+// ----------------------------------------------------------------------------------------------
+
+// Best win probability for any prior and any n, in O(n)
+class TopSetSolver
+{
+public:
+    TopSetSolver(const std::vector<double>& prior, int guessLimit)
+    {
+        const std::size_t n{ prior.size() };
+        const std::size_t winnable{ guessLimit >= 63 ? n : std::min<std::size_t>(n, (std::uint64_t{ 1 } << guessLimit) - 1) };
+
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        if (winnable < n)
+        {
+            std::nth_element(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(winnable), order.end(),
+                             [&](int a, int b) { return prior[static_cast<std::size_t>(a)] > prior[static_cast<std::size_t>(b)]; });
+            order.resize(winnable);
+            order.shrink_to_fit();
+        }
+        std::sort(order.begin(), order.end());
+        m_targets = std::move(order);
+
+        for (int i : m_targets)
+            m_winProbability += prior[static_cast<std::size_t>(i)];
+    }
+
+    double winProbability() const { return m_winProbability; }
+
+    // The middle one of the targets still in low..high. (Doesn't depend on the guesses left: the
+    // targets were picked so that there are always enough.)
+    int bestGuess(int low, int high) const
+    {
+        const auto first{ std::lower_bound(m_targets.begin(), m_targets.end(), low) };
+        const auto last{ std::upper_bound(first, m_targets.end(), high) };
+        if (first == last)
+            return low; // none left: this game is lost whatever we guess
+        return *(first + (last - first - 1) / 2);
+    }
+
+    std::size_t memoryBytes() const { return m_targets.capacity() * sizeof(int); }
+
+private:
+    std::vector<int> m_targets{}; // sorted
+    double m_winProbability{ 0.0 };
+};
+
+// ----------------------------------------------------------------------------------------------
+
+// Best expected reward for a uniform prior over n numbers: guess the middle, so level d of the tree
+// (guess number d) holds 2^(d - 1) numbers until the range runs out
+double uniformBest(std::int64_t n, const std::vector<double>& rewards)
+{
+    double total{ 0.0 };
+    std::int64_t left{ n };
+    for (std::size_t d{ 1 }; d < rewards.size() && left > 0; ++d)
+    {
+        const std::int64_t level{ std::min<std::int64_t>(left, d >= 63 ? left : std::int64_t{ 1 } << (d - 1)) };
+        total += rewards[d] * static_cast<double>(level);
+        left -= level;
+    }
+    return n == 0 ? 0.0 : total / static_cast<double>(n);
+}
+
+// playHiLo() from quiz_q3_HiLo-Game.cpp, with the guesses coming from nextGuess(low, high, guessesLeft)
+// instead of std::cin. Returns the number of guesses it took, or 0 if all guesses were used up.
+template <typename Strategy>
+int playHiLoWith(int guessLimit, int min, int max, int secret, Strategy nextGuess)
+{
+    int low{ min };
+    int high{ max };
+    for (int num{ 1 }; num <= guessLimit; ++num)
+    {
+        const int answer{ nextGuess(low, high, guessLimit - num + 1) };
+        if (answer > secret)
+            high = answer - 1; // "Too High!"
+        else if (answer < secret)
+            low = answer + 1; // "Too Low!"
+        else
+            return num;
+    }
+    return 0;
+}
+
+// Plays every possible secret and adds up reward * probability: what the strategy really achieves
+template <typename Strategy>
+double playAll(const std::vector<double>& prior, const std::vector<double>& rewards, Strategy nextGuess)
+{
+    const int guessLimit{ static_cast<int>(rewards.size()) - 1 };
+    const int max{ static_cast<int>(prior.size()) - 1 };
+    double total{ 0.0 };
+    for (int secret{ 0 }; secret <= max; ++secret)
+    {
+        const int guesses{ playHiLoWith(guessLimit, 0, max, secret, nextGuess) };
+        if (guesses > 0)
+            total += rewards[static_cast<std::size_t>(guesses)] * prior[static_cast<std::size_t>(secret)];
+    }
+    return total;
+}
+
+template <typename Fn>
+double seconds(Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    fn();
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    return elapsed.count();
+}
+
+std::vector<double> uniformPrior(std::size_t n)
+{
+    return std::vector<double>(n, 1.0 / static_cast<double>(n));
+}
+
+// Random weights, heavy-tailed so a few numbers matter a lot
+std::vector<double> randomPrior(std::size_t n, std::mt19937_64& mt)
+{
+    std::exponential_distribution<double> weight{ 1.0 };
+    std::vector<double> prior(n);
+    double total{ 0.0 };
+    for (double& p : prior)
+    {
+        const double w{ weight(mt) };
+        p = w * w * w;
+        total += p;
+    }
+    for (double& p : prior)
+        p /= total;
+    return prior;
+}
+
+// People asked for a number from 1 to 100 like 7s, 37, 42 and 69, and avoid the round numbers and the ends
+std::vector<double> humanPrior()
+{
+    std::vector<double> prior(100, 1.0);
+    for (int number{ 1 }; number <= 100; ++number)
+    {
+        double& p{ prior[static_cast<std::size_t>(number - 1)] };
+        if (number % 10 == 7 || number / 10 == 7)
+            p *= 2.5;
+        if (number == 37 || number == 42 || number == 69)
+            p *= 4.0;
+        if (number % 10 == 0 || number <= 3 || number >= 98)
+            p *= 0.3;
+    }
+    double total{ 0.0 };
+    for (double p : prior)
+        total += p;
+    for (double& p : prior)
+        p /= total;
+    return prior;
+}
+
+bool near(double a, double b)
+{
+    return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+int main()
+{
+    // ---- quiz_q3_HiLo-Game.cpp's game: 1 to 100 with 7 guesses, and a few tighter limits ----
+    std::cout << "1 to 100, playing perfectly:\n";
+    std::cout << "guesses | win (uniform)  score (uniform) | win (human-ish prior)  score\n";
+    const std::vector<double> human{ humanPrior() };
+    for (int guessLimit : { 4, 5, 6, 7 })
+    {
+        const IntervalSolver uniformWin{ uniformPrior(100), winRewards(guessLimit) };
+        const IntervalSolver uniformScore{ uniformPrior(100), scoreRewards(guessLimit) };
+        const IntervalSolver humanWin{ human, winRewards(guessLimit) };
+        const IntervalSolver humanScore{ human, scoreRewards(guessLimit) };
+        std::cout << std::setw(7) << guessLimit << " | " << std::fixed << std::setprecision(1) << std::setw(12)
+                  << 100.0 * uniformWin.best() << "%  " << std::setw(15) << uniformScore.best() << " | " << std::setw(20)
+                  << 100.0 * humanWin.best() << "%  " << std::setw(5) << humanScore.best() << '\n'
+                  << std::defaultfloat << std::setprecision(6);
+    }
+
+    {
+        const IntervalSolver solver{ uniformPrior(100), scoreRewards(7) };
+        const int secret{ 73 };
+        std::cout << "\nBest play for secret " << secret << " with 7 guesses, for the most points:";
+        playHiLoWith(7, 1, 100, secret, [&](int low, int high, int guessesLeft) {
+            const int guess{ 1 + solver.bestGuess(low - 1, high - 1, guessesLeft) };
+            std::cout << ' ' << guess;
+            return guess;
+        });
+        std::cout << '\n';
+    }
+
+    // ---- Checks ----
+    // IntervalSolver's answer is what its policy really scores; TopSetSolver and uniformBest() agree with it
+    std::mt19937_64 mt{ 50 };
+    int failures{ 0 };
+    int checks{ 0 };
+    for (std::size_t n : { 1u, 2u, 3u, 7u, 8u, 20u, 63u, 64u, 100u, 150u })
+    {
+        for (int guessLimit{ 1 }; guessLimit <= 8; ++guessLimit)
+        {
+            for (int trial{ 0 }; trial < 3; ++trial)
+            {
+                const std::vector<double> prior{ trial == 0 ? uniformPrior(n) : randomPrior(n, mt) };
+                for (const std::vector<double>& rewards : { winRewards(guessLimit), scoreRewards(guessLimit) })
+                {
+                    const IntervalSolver solver{ prior, rewards };
+                    const double played{ playAll(prior, rewards, [&](int low, int high, int guessesLeft) {
+                        return solver.bestGuess(low, high, guessesLeft);
+                    }) };
+                    bool ok{ near(played, solver.best()) };
+                    if (rewards[1] == 1.0)
+                    {
+                        const TopSetSolver topSet{ prior, guessLimit };
+                        ok = ok && near(topSet.winProbability(), solver.best())
+                             && near(playAll(prior, rewards, [&](int low, int high, int) { return topSet.bestGuess(low, high); }), solver.best());
+                    }
+                    if (trial == 0)
+                        ok = ok && near(uniformBest(static_cast<std::int64_t>(n), rewards), solver.best());
+                    failures += !ok;
+                    ++checks;
+                }
+            }
+        }
+    }
+    std::cout << "\nChecks: " << checks - failures << " of " << checks << " passed\n";
+
+    // ---- Benchmarks ----
+    const unsigned cores{ std::max(1u, std::thread::hardware_concurrency()) };
+    std::cout << "\nIntervalSolver (any prior, any rewards), " << cores << " thread(s):\n";
+    for (std::size_t n : { 100u, 200u, 400u, 800u })
+    {
+        const int guessLimit{ static_cast<int>(std::ceil(std::log2(static_cast<double>(n)))) };
+        const std::vector<double> prior{ randomPrior(n, mt) };
+        std::size_t bytes{ 0 };
+        double best{ 0.0 };
+        const double time{ seconds([&] {
+            const IntervalSolver solver{ prior, scoreRewards(guessLimit) };
+            bytes = solver.memoryBytes();
+            best = solver.best();
+        }) };
+        std::cout << "  n = " << std::setw(4) << n << ", " << guessLimit << " guesses: " << std::setw(8) << time * 1000 << " ms, "
+                  << std::setw(6) << bytes / 1024 << " KiB (expected score " << best << ")\n";
+    }
+
+    std::cout << "\nTopSetSolver (best win probability, any prior):\n";
+    for (std::size_t n : { 1'000'000u, 10'000'000u })
+    {
+        const int guessLimit{ 18 };
+        const std::vector<double> prior{ randomPrior(n, mt) };
+        double win{ 0.0 };
+        std::size_t bytes{ 0 };
+        double played{ 0.0 };
+        const double time{ seconds([&] {
+            const TopSetSolver solver{ prior, guessLimit };
+            win = solver.winProbability();
+            bytes = solver.memoryBytes();
+            if (n == 1'000'000)
+            {
+                played = playAll(prior, winRewards(guessLimit), [&](int low, int high, int) { return solver.bestGuess(low, high); });
+            }
+        }) };
+        std::cout << "  n = " << n << ", " << guessLimit << " guesses: win " << 100.0 * win << "% vs "
+                  << 100.0 * uniformBest(static_cast<std::int64_t>(n), winRewards(guessLimit)) << "% for a uniform prior, "
+                  << time * 1000 << " ms, policy " << bytes / 1024 << " KiB";
+        if (n == 1'000'000)
+            std::cout << " (solve + play all " << n << " secrets; played: " << 100.0 * played << "%)";
+        std::cout << '\n';
+    }
+
+    std::cout << "\nUniform prior, 1 to 1'000'000, guessing the middle:\n";
+    for (int guessLimit : { 10, 15, 20 })
+    {
+        const std::vector<double> prior{ uniformPrior(1'000'000) };
+        const std::vector<double> rewards{ scoreRewards(guessLimit) };
+        const double closedForm{ uniformBest(1'000'000, rewards) };
+        const double played{ playAll(prior, rewards, [](int low, int high, int) { return low + (high - low) / 2; }) };
+        std::cout << "  " << guessLimit << " guesses: win " << 100.0 * uniformBest(1'000'000, winRewards(guessLimit))
+                  << "%, expected score " << closedForm << " (played: " << played << ")\n";
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
+/* Sample results (one slow core):
+1 to 100, playing perfectly:
+guesses | win (uniform)  score (uniform) | win (human-ish prior)  score
+      4 |         15.0%             65.0 |                 36.8%  182.1
+      5 |         31.0%            114.0 |                 54.8%  253.8
+      6 |         63.0%            199.7 |                 79.3%  331.1
+      7 |        100.0%            313.6 |                100.0%  416.7
+
+Best play for secret 73 with 7 guesses, for the most points: 37 69 85 77 73
+
+Checks: 480 of 480 passed
+
+IntervalSolver (any prior, any rewards), 1 thread(s):
+  n =  100, 7 guesses:      3.7 ms,    449 KiB
+  n =  200, 8 guesses:     34   ms,   1875 KiB
+  n =  400, 9 guesses:    276   ms,   7812 KiB
+  n =  800, 10 guesses:  2331   ms,  32500 KiB   (O(n^3): doubling n costs 8x)
+
+TopSetSolver (best win probability, any prior):
+  n = 1000000, 18 guesses: win 95.2% vs 26.2% for a uniform prior, 782 ms, policy 1023 KiB
+                           (solve + play all 1000000 secrets; played: 95.2%)
+  n = 10000000, 18 guesses: win 50.7% vs 2.6% for a uniform prior, 212 ms, policy 1023 KiB
+
+Uniform prior, 1 to 1'000'000, guessing the middle:
+  10 guesses: win 0.1023%, expected score 0.2036 (played: 0.2036)
+  15 guesses: win 3.2767%, expected score 4.35233 (played: 4.35233)
+  20 guesses: win 100%, expected score 102.428 (played: 102.428)
+*/
@@ -0,0 +1,556 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <algorithm> // for std::clamp, std::min
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring> // for std::memcpy
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility> // for std::move
+#include <vector>
+#include <immintrin.h>
+#include "../Chapter_4/cpu_features.h"
+
+#ifdef _WIN32
+#include <io.h> // for _commit, _fileno
+#else
+#include <unistd.h> // for fsync, fileno
+#endif
+
+// Keeps Hi-Lo results after the program exits.
+//
+// Every game (and every new player name) is appended to a log file as a small "frame":
+//     crc32c (4 bytes) | type (2 bytes) | payload size (2 bytes) | payload
+// The checksum covers everything after it, so a frame half-written when the power went out
+// is detected on the next start and cut off, instead of being read back as garbage.
+//
+// Writing to disk is cheap; making sure it is really ON the disk (fsync) is not. So appends are
+// collected in memory and written + fsync'ed in batches. A crash loses at most the last batch.
+//
+// Queries (best score per player, top N, percentiles) are answered from an index kept in memory.
+// Rebuilding that index by replaying a huge log takes a while, so saveSnapshot() writes the whole
+// index to a second file, together with how much of the log it covers. On restart only the part
+// of the log written after the snapshot has to be replayed.
+//
+// Scores are ints from 0 to maxScore (higher is better). That small range keeps the index tiny:
+// a count per score value instead of a sorted list of every game.
+// Requires C++17 or newer.
+namespace Leaderboard
+{
+	constexpr int maxScore{ 1000 };
+
+	// ---- CRC-32C checksum (the SSE4.2 crc32 instruction computes exactly this one) ----
+
+	inline std::uint32_t crc32cScalar(const unsigned char* data, std::size_t n, std::uint32_t crc)
+	{
+		static const std::array<std::uint32_t, 256> table{ [] {
+			std::array<std::uint32_t, 256> t{};
+			for (std::uint32_t i{ 0 }; i < 256; ++i)
+			{
+				std::uint32_t c{ i };
+				for (int bit{ 0 }; bit < 8; ++bit)
+					c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+				t[i] = c;
+			}
+			return t;
+		}() };
+
+		for (std::size_t i{ 0 }; i < n; ++i)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return crc;
+	}
+
+	CPU_TARGET_SSE42 inline std::uint32_t crc32cSse42(const unsigned char* data, std::size_t n, std::uint32_t crc)
+	{
+		std::uint64_t crc64{ crc };
+		std::size_t i{ 0 };
+		for (; i + 8 <= n; i += 8)
+		{
+			std::uint64_t word{};
+			std::memcpy(&word, data + i, 8);
+			crc64 = _mm_crc32_u64(crc64, word);
+		}
+		crc = static_cast<std::uint32_t>(crc64);
+		for (; i < n; ++i)
+			crc = _mm_crc32_u8(crc, data[i]);
+		return crc;
+	}
+
+	using CrcFn = std::uint32_t (*)(const unsigned char* data, std::size_t n, std::uint32_t crc);
+
+	inline std::uint32_t crc32c(const void* data, std::size_t n)
+	{
+		static const CrcFn impl{ CpuFeatures::select<CrcFn>({ crc32cScalar, crc32cSse42 }) };
+		return ~impl(static_cast<const unsigned char*>(data), n, 0xFFFFFFFFu);
+	}
+
+	// fflush only hands the data to the operating system; this waits until it's on the disk.
+	// Returns false if either step failed (e.g. the disk is full).
+	inline bool flushToDisk(std::FILE* file)
+	{
+		if (std::fflush(file) != 0)
+			return false;
+#ifdef _WIN32
+		return _commit(_fileno(file)) == 0;
+#else
+		return fsync(fileno(file)) == 0;
+#endif
+	}
+
+	// ---- Log frames ----
+
+	enum class FrameType : std::uint16_t
+	{
+		player = 1, // payload: uint32 player id, then the name's characters
+		game = 2,   // payload: GameResult
+	};
+
+	struct GameResult
+	{
+		std::uint32_t player{};
+		std::int32_t score{};
+		std::int64_t unixSeconds{};
+	};
+
+	constexpr std::size_t frameHeaderSize{ 8 };
+
+	struct Entry
+	{
+		std::uint32_t player{};
+		std::string_view name{};
+		int score{};
+	};
+
+	class Store
+	{
+	public:
+		// Opens (or creates) the log. If snapshotPath holds a valid snapshot, only the log after it
+		// is replayed. A damaged tail (from a crash mid-write) is cut off.
+		// syncEvery: how many records to collect before writing them out and calling fsync.
+		Store(std::string logPath, std::string snapshotPath, std::size_t syncEvery = 4096)
+			: m_logPath{ std::move(logPath) }, m_snapshotPath{ std::move(snapshotPath) }, m_syncEvery{ syncEvery }
+		{
+			m_bestBuckets.resize(maxScore + 1);
+			recover();
+			m_log = std::fopen(m_logPath.c_str(), "ab");
+		}
+
+		~Store()
+		{
+			if (m_log)
+			{
+				sync();
+				std::fclose(m_log);
+			}
+		}
+
+		Store(const Store&) = delete;
+		Store& operator=(const Store&) = delete;
+
+		bool isOpen() const { return m_log != nullptr; }
+
+		// Id for a player name, registering (and logging) the name the first time it's seen.
+		// Names are kept to their first 255 characters (the snapshot stores the length in one byte),
+		// so two names that only differ after that are the same player.
+		std::uint32_t playerId(std::string_view fullName)
+		{
+			const std::string name{ fullName.substr(0, 255) };
+			const auto found{ m_idOf.find(name) };
+			if (found != m_idOf.end())
+				return found->second;
+
+			const std::uint32_t id{ static_cast<std::uint32_t>(m_names.size()) };
+			std::string payload(sizeof(id), '\0');
+			std::memcpy(payload.data(), &id, sizeof(id));
+			payload += name;
+			appendFrame(FrameType::player, payload.data(), payload.size());
+			addPlayer(name);
+			return id;
+		}
+
+		void record(std::uint32_t player, int score, std::int64_t unixSeconds)
+		{
+			const GameResult game{ player, std::clamp(score, 0, maxScore), unixSeconds };
+			appendFrame(FrameType::game, &game, sizeof(game));
+			addGame(game);
+		}
+
+		// Write out everything recorded so far and wait until it's on disk.
+		// Returns false if that failed; the records are then kept in memory and tried again next time.
+		bool sync()
+		{
+			if (m_pending.empty())
+				return true;
+			if (!m_log)
+				return false;
+			const bool written{ std::fwrite(m_pending.data(), 1, m_pending.size(), m_log) == m_pending.size() };
+			if (!flushToDisk(m_log) || !written)
+			{
+				// Part of the batch may be in the file, ending in half a frame. Cut the log back to the
+				// last record that's known to be good, or recover() would stop at that torn frame and
+				// throw away everything appended after it.
+				std::fclose(m_log);
+				std::error_code error{};
+				std::filesystem::resize_file(m_logPath, m_logSize, error);
+				m_log = std::fopen(m_logPath.c_str(), "ab");
+				return false;
+			}
+			m_logSize += m_pending.size();
+			m_pending.clear();
+			m_pendingRecords = 0;
+			return true;
+		}
+
+		// Save the index so the next start only replays the log written after this point.
+		// Written to a temporary file first and then renamed, so a crash here never leaves a half snapshot.
+		bool saveSnapshot()
+		{
+			// The index already counts the pending records, so a snapshot saying it covers less log
+			// than that would replay them twice once they do get written
+			if (!sync())
+				return false;
+
+			std::string out{ "HLSNAP01" };
+			auto put{ [&out](const auto& value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); } };
+			put(static_cast<std::uint64_t>(m_logSize));
+			put(static_cast<std::uint64_t>(m_names.size()));
+			for (std::size_t p{ 0 }; p < m_names.size(); ++p)
+			{
+				put(static_cast<std::uint8_t>(m_names[p].size()));
+				out += m_names[p];
+				put(static_cast<std::int32_t>(m_best[p]));
+			}
+			for (std::uint64_t count : m_gameCounts)
+				put(count);
+			put(crc32c(out.data(), out.size()));
+
+			const std::string temp{ m_snapshotPath + ".tmp" };
+			std::FILE* file{ std::fopen(temp.c_str(), "wb") };
+			if (!file)
+				return false;
+			bool written{ std::fwrite(out.data(), 1, out.size(), file) == out.size() };
+			written = flushToDisk(file) && written;
+			std::fclose(file);
+			if (!written)
+			{
+				std::filesystem::remove(temp);
+				return false; // keep the old snapshot rather than replace it with a partial one
+			}
+
+			std::error_code error{};
+			std::filesystem::rename(temp, m_snapshotPath, error); // replaces the old snapshot
+			return !error;
+		}
+
+		// ---- Queries ----
+
+		std::size_t players() const { return m_names.size(); }
+		std::uint64_t games() const { return m_totalGames; }
+		std::string_view name(std::uint32_t player) const { return m_names[player]; }
+
+		// Best score of a player, or -1 if they haven't finished a game
+		int best(std::uint32_t player) const { return player < m_best.size() ? m_best[player] : -1; }
+
+		// Players with the highest best scores, highest first (ties in no particular order)
+		std::vector<Entry> top(std::size_t n) const
+		{
+			std::vector<Entry> result{};
+			for (int score{ maxScore }; score >= 0 && result.size() < n; --score)
+			{
+				for (std::uint32_t player : m_bestBuckets[static_cast<std::size_t>(score)])
+				{
+					if (result.size() == n)
+						break;
+					result.push_back({ player, m_names[player], score });
+				}
+			}
+			return result;
+		}
+
+		// Percent of all games that scored less than score (ties count half)
+		double percentileOf(int score) const
+		{
+			if (m_totalGames == 0)
+				return 0.0;
+			std::uint64_t below{ 0 };
+			for (int s{ 0 }; s < score && s <= maxScore; ++s)
+				below += m_gameCounts[static_cast<std::size_t>(s)];
+			const std::uint64_t equal{ score >= 0 && score <= maxScore ? m_gameCounts[static_cast<std::size_t>(score)] : 0 };
+			return 100.0 * (static_cast<double>(below) + 0.5 * static_cast<double>(equal)) / static_cast<double>(m_totalGames);
+		}
+
+		// Lowest score that at least percent% of games reached or stayed under (e.g. 50 = the median)
+		int scoreAtPercentile(double percent) const
+		{
+			const double wanted{ percent / 100.0 * static_cast<double>(m_totalGames) };
+			std::uint64_t seen{ 0 };
+			for (int s{ 0 }; s <= maxScore; ++s)
+			{
+				seen += m_gameCounts[static_cast<std::size_t>(s)];
+				if (static_cast<double>(seen) >= wanted && seen > 0)
+					return s;
+			}
+			return maxScore;
+		}
+
+		// What happened at startup, for printing
+		struct RecoveryInfo
+		{
+			bool usedSnapshot{};
+			std::uint64_t replayedBytes{};
+			std::uint64_t replayedRecords{};
+			std::uint64_t truncatedBytes{};
+		};
+		const RecoveryInfo& recoveryInfo() const { return m_recovery; }
+
+	private:
+		void appendFrame(FrameType type, const void* payload, std::size_t size)
+		{
+			const std::size_t start{ m_pending.size() };
+			m_pending.resize(start + frameHeaderSize + size);
+			char* frame{ m_pending.data() + start };
+
+			const auto type16{ static_cast<std::uint16_t>(type) };
+			const auto size16{ static_cast<std::uint16_t>(size) };
+			std::memcpy(frame + 4, &type16, 2);
+			std::memcpy(frame + 6, &size16, 2);
+			std::memcpy(frame + 8, payload, size);
+			const std::uint32_t crc{ crc32c(frame + 4, 4 + size) };
+			std::memcpy(frame, &crc, 4);
+
+			if (++m_pendingRecords >= m_syncEvery)
+				sync();
+		}
+
+		void addPlayer(std::string name)
+		{
+			m_idOf.emplace(name, static_cast<std::uint32_t>(m_names.size()));
+			m_names.push_back(std::move(name));
+			m_best.push_back(-1);
+			m_bucketSlot.push_back(0);
+		}
+
+		void setBest(std::uint32_t player, int score)
+		{
+			const int old{ m_best[player] };
+			if (old >= 0)
+			{
+				// Remove from the old bucket by moving its last player into the hole
+				std::vector<std::uint32_t>& bucket{ m_bestBuckets[static_cast<std::size_t>(old)] };
+				const std::uint32_t slot{ m_bucketSlot[player] };
+				bucket[slot] = bucket.back();
+				m_bucketSlot[bucket[slot]] = slot;
+				bucket.pop_back();
+			}
+			std::vector<std::uint32_t>& bucket{ m_bestBuckets[static_cast<std::size_t>(score)] };
+			m_bucketSlot[player] = static_cast<std::uint32_t>(bucket.size());
+			bucket.push_back(player);
+			m_best[player] = score;
+		}
+
+		void addGame(const GameResult& game)
+		{
+			++m_gameCounts[static_cast<std::size_t>(game.score)];
+			++m_totalGames;
+			if (game.player < m_best.size() && game.score > m_best[game.player])
+				setBest(game.player, game.score);
+		}
+
+		bool loadSnapshot()
+		{
+			std::FILE* file{ std::fopen(m_snapshotPath.c_str(), "rb") };
+			if (!file)
+				return false;
+			std::string in{};
+			char chunk[1 << 16];
+			std::size_t got{};
+			while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+				in.append(chunk, got);
+			std::fclose(file);
+
+			if (in.size() < 8 + 16 + sizeof(m_gameCounts) + 4 || in.compare(0, 8, "HLSNAP01") != 0)
+				return false;
+			std::uint32_t storedCrc{};
+			std::memcpy(&storedCrc, in.data() + in.size() - 4, 4);
+			if (crc32c(in.data(), in.size() - 4) != storedCrc)
+				return false;
+
+			std::size_t pos{ 8 };
+			auto get{ [&in, &pos](auto& value) {
+				std::memcpy(&value, in.data() + pos, sizeof(value));
+				pos += sizeof(value);
+			} };
+			std::uint64_t logOffset{};
+			std::uint64_t numPlayers{};
+			get(logOffset);
+			get(numPlayers);
+			for (std::uint64_t p{ 0 }; p < numPlayers; ++p)
+			{
+				std::uint8_t length{};
+				get(length);
+				addPlayer(in.substr(pos, length));
+				pos += length;
+				std::int32_t best{};
+				get(best);
+				if (best >= 0)
+					setBest(static_cast<std::uint32_t>(p), best);
+			}
+			for (std::uint64_t& count : m_gameCounts)
+			{
+				get(count);
+				m_totalGames += count;
+			}
+			m_logSize = logOffset;
+			return true;
+		}
+
+		// Apply one frame to the index. Returns false if it doesn't make sense.
+		bool replay(FrameType type, const char* payload, std::size_t size)
+		{
+			if (type == FrameType::game && size == sizeof(GameResult))
+			{
+				GameResult game{};
+				std::memcpy(&game, payload, sizeof(game));
+				if (game.score < 0 || game.score > maxScore)
+					return false;
+				addGame(game);
+				return true;
+			}
+			if (type == FrameType::player && size >= 4)
+			{
+				std::uint32_t id{};
+				std::memcpy(&id, payload, 4);
+				if (id != m_names.size())
+					return false;
+				addPlayer(std::string{ payload + 4, size - 4 });
+				return true;
+			}
+			return false;
+		}
+
+		void recover()
+		{
+			std::error_code error{};
+			const std::uint64_t fileSize{ std::filesystem::exists(m_logPath, error) ? std::filesystem::file_size(m_logPath, error) : 0 };
+
+			m_recovery.usedSnapshot = loadSnapshot();
+			if (!m_recovery.usedSnapshot || m_logSize > fileSize)
+			{
+				// No usable snapshot (or it's newer than the log, which means the log was replaced): start from nothing
+				resetIndex();
+				m_recovery.usedSnapshot = false;
+			}
+
+			std::FILE* file{ std::fopen(m_logPath.c_str(), "rb") };
+			if (!file)
+				return;
+
+			// Read the tail in big chunks; a frame can straddle two chunks, so keep the leftover bytes
+			std::vector<char> buffer(1 << 22);
+			std::size_t have{ 0 };
+			std::uint64_t offset{ m_logSize }; // log offset of buffer[0]
+			bool bad{ false };
+			std::fseek(file, 0, SEEK_SET);
+			for (std::uint64_t skip{ m_logSize }; skip > 0;)
+			{
+				// fseek takes a long, which is only 32 bits on Windows, so skip in steps
+				const long step{ static_cast<long>(std::min<std::uint64_t>(skip, 1u << 30)) };
+				std::fseek(file, step, SEEK_CUR);
+				skip -= static_cast<std::uint64_t>(step);
+			}
+
+			while (!bad)
+			{
+				const std::size_t got{ std::fread(buffer.data() + have, 1, buffer.size() - have, file) };
+				have += got;
+
+				std::size_t pos{ 0 };
+				while (pos + frameHeaderSize <= have)
+				{
+					std::uint32_t crc{};
+					std::uint16_t type{};
+					std::uint16_t size{};
+					std::memcpy(&crc, buffer.data() + pos, 4);
+					std::memcpy(&type, buffer.data() + pos + 4, 2);
+					std::memcpy(&size, buffer.data() + pos + 6, 2);
+					if (pos + frameHeaderSize + size > have)
+						break; // the rest of this frame is in the next chunk (or missing)
+
+					const char* frame{ buffer.data() + pos };
+					if (crc32c(frame + 4, 4 + size) != crc || !replay(static_cast<FrameType>(type), frame + 8, size))
+					{
+						bad = true;
+						break;
+					}
+					pos += frameHeaderSize + size;
+					++m_recovery.replayedRecords;
+				}
+
+				offset += pos;
+				std::memmove(buffer.data(), buffer.data() + pos, have - pos);
+				have -= pos;
+				if (got == 0)
+					break;
+			}
+			std::fclose(file);
+
+			m_recovery.replayedBytes = offset - m_logSize;
+			m_logSize = offset;
+			if (offset < fileSize)
+			{
+				// A damaged or half-written tail: cut it off so new records go right after the last good one
+				m_recovery.truncatedBytes = fileSize - offset;
+				std::fprintf(stderr, "%s: damaged record at byte %llu, discarding the last %llu bytes\n", m_logPath.c_str(),
+					static_cast<unsigned long long>(offset), static_cast<unsigned long long>(m_recovery.truncatedBytes));
+				std::filesystem::resize_file(m_logPath, offset, error);
+			}
+		}
+
+		void resetIndex()
+		{
+			m_names.clear();
+			m_idOf.clear();
+			m_best.clear();
+			m_bucketSlot.clear();
+			for (std::vector<std::uint32_t>& bucket : m_bestBuckets)
+				bucket.clear();
+			m_gameCounts.fill(0);
+			m_totalGames = 0;
+			m_logSize = 0;
+		}
+
+		std::string m_logPath{};
+		std::string m_snapshotPath{};
+		std::size_t m_syncEvery{};
+		std::FILE* m_log{ nullptr };
+		std::uint64_t m_logSize{ 0 }; // bytes of the log that are safely on disk
+		std::vector<char> m_pending{};
+		std::size_t m_pendingRecords{ 0 };
+		RecoveryInfo m_recovery{};
+
+		// The index
+		std::vector<std::string> m_names{};
+		std::unordered_map<std::string, std::uint32_t> m_idOf{};
+		std::vector<int> m_best{};                              // best score per player, -1 = none yet
+		std::vector<std::vector<std::uint32_t>> m_bestBuckets{}; // players grouped by their best score
+		std::vector<std::uint32_t> m_bucketSlot{};             // where each player sits in their bucket
+		std::array<std::uint64_t, maxScore + 1> m_gameCounts{}; // number of games per score
+		std::uint64_t m_totalGames{ 0 };
+	};
+
+	// Turn a Hi-Lo game into a score: 0 for a loss, otherwise more for fewer guesses
+	// (guessing right on the first try is maxScore)
+	constexpr int hiLoScore(bool won, int guessesUsed, int guessLimit)
+	{
+		if (!won || guessLimit <= 0)
+			return 0;
+		return maxScore * (guessLimit - guessesUsed + 1) / guessLimit;
+	}
+}
+
+#endif
@@ -0,0 +1,154 @@
+// Benchmarks for leaderboard.h: how fast games can be appended, how long a restart takes with and
+// without a snapshot, and how fast the queries are.
+//
+// Usage: leaderboard_bench [records] [directory]
+//   records:   number of games to write (default 10 million; 100 million makes a ~2.4 GB log)
+//   directory: where to put the files (default: the current directory). They are deleted at the end.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib> // for std::atoll
+#include <filesystem>
+#include <iostream>
+#include <memory> // for std::unique_ptr
+#include <random>
+#include <string>
+#include <vector>
+#include "leaderboard.h"
+
+template <typename Fn>
+double seconds(Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    fn();
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    const std::uint64_t numRecords{ argc > 1 ? static_cast<std::uint64_t>(std::atoll(argv[1])) : 10'000'000 };
+    const std::filesystem::path dir{ argc > 2 ? argv[2] : "." };
+    const std::string logPath{ (dir / "hilo_bench.log").string() };
+    const std::string snapshotPath{ (dir / "hilo_bench.snap").string() };
+    std::filesystem::remove(logPath);
+    std::filesystem::remove(snapshotPath);
+
+    constexpr std::uint32_t numPlayers{ 100'000 };
+    constexpr int guessLimit{ 7 };
+    std::mt19937 mt{ 5 };
+
+    // What fsync'ing every single record costs, for comparison (a few thousand is plenty to see it)
+    {
+        const std::string path{ (dir / "hilo_every.log").string() };
+        std::filesystem::remove(path);
+        constexpr int count{ 2000 };
+        double elapsed{};
+        {
+            Leaderboard::Store store{ path, path + ".snap", 1 };
+            const std::uint32_t player{ store.playerId("solo") };
+            elapsed = seconds([&] {
+                for (int i{ 0 }; i < count; ++i)
+                    store.record(player, static_cast<int>(mt() % 1001), i);
+            });
+        }
+        std::filesystem::remove(path);
+        std::cout << "fsync every record:   " << count / elapsed << " appends/sec\n";
+    }
+
+    // Write the log in batches, with a snapshot taken just before the last 1%
+    int referenceBest{};
+    int referenceMedian{};
+    std::vector<Leaderboard::Entry> referenceTop{};
+    {
+        Leaderboard::Store store{ logPath, snapshotPath };
+        for (std::uint32_t p{ 0 }; p < numPlayers; ++p)
+            store.playerId("player" + std::to_string(p));
+
+        const std::uint64_t snapshotAt{ numRecords - numRecords / 100 };
+        double snapshotSeconds{};
+        const double elapsed{ seconds([&] {
+            for (std::uint64_t i{ 0 }; i < numRecords; ++i)
+            {
+                const int guesses{ 1 + static_cast<int>(mt() % (guessLimit + 2)) };
+                const int score{ Leaderboard::hiLoScore(guesses <= guessLimit, guesses, guessLimit) };
+                store.record(static_cast<std::uint32_t>(mt() % numPlayers), score, static_cast<std::int64_t>(i));
+                if (i + 1 == snapshotAt)
+                    snapshotSeconds = seconds([&] { store.saveSnapshot(); });
+            }
+            store.sync();
+        }) };
+
+        std::cout << "batched fsync (4096): " << numRecords / elapsed << " appends/sec, "
+                  << std::filesystem::file_size(logPath) / elapsed / 1e6 << " MB/s\n";
+        std::cout << "snapshot:             " << snapshotSeconds * 1e3 << " ms\n\n";
+
+        referenceBest = store.best(123);
+        referenceMedian = store.scoreAtPercentile(50.0);
+        for (const Leaderboard::Entry& entry : store.top(3))
+            referenceTop.push_back(entry);
+
+        // Query speed
+        constexpr int queries{ 1'000'000 };
+        long long sink{ 0 };
+        const double bestTime{ seconds([&] {
+            for (int i{ 0 }; i < queries; ++i)
+                sink += store.best(static_cast<std::uint32_t>(mt() % numPlayers));
+        }) };
+        const double topTime{ seconds([&] {
+            for (int i{ 0 }; i < 10'000; ++i)
+                sink += static_cast<long long>(store.top(10).size());
+        }) };
+        const double percentileTime{ seconds([&] {
+            for (int i{ 0 }; i < 100'000; ++i)
+                sink += static_cast<long long>(store.percentileOf(static_cast<int>(mt() % 1001)));
+        }) };
+        std::cout << "best(player):         " << bestTime / queries * 1e9 << " ns\n";
+        std::cout << "top(10):              " << topTime / 10'000 * 1e9 << " ns\n";
+        std::cout << "percentileOf(score):  " << percentileTime / 100'000 * 1e9 << " ns   (checksum " << sink << ")\n\n";
+    }
+
+    auto sameAnswers{ [&](const Leaderboard::Store& store) {
+        const std::vector<Leaderboard::Entry> top{ store.top(3) };
+        bool same{ store.best(123) == referenceBest && store.scoreAtPercentile(50.0) == referenceMedian && store.games() == numRecords };
+        for (std::size_t i{ 0 }; i < top.size(); ++i)
+            same = same && top[i].score == referenceTop[i].score;
+        return same;
+    } };
+
+    // Restart with the snapshot: only the last 1% of the log is replayed
+    {
+        std::unique_ptr<Leaderboard::Store> store{};
+        const double elapsed{ seconds([&] { store = std::make_unique<Leaderboard::Store>(logPath, snapshotPath); }) };
+        const auto& info{ store->recoveryInfo() };
+        std::cout << "recovery, snapshot + tail: " << elapsed * 1e3 << " ms (replayed " << info.replayedRecords << " records, "
+                  << (sameAnswers(*store) ? "same answers" : "DIFFERENT answers!") << ")\n";
+    }
+
+    // Restart without it: replay everything
+    {
+        std::filesystem::rename(snapshotPath, snapshotPath + ".hidden");
+        std::unique_ptr<Leaderboard::Store> store{};
+        const double elapsed{ seconds([&] { store = std::make_unique<Leaderboard::Store>(logPath, snapshotPath); }) };
+        const auto& info{ store->recoveryInfo() };
+        std::cout << "recovery, full replay:     " << elapsed * 1e3 << " ms (replayed " << info.replayedRecords << " records, "
+                  << info.replayedBytes / elapsed / 1e9 << " GB/s, " << (sameAnswers(*store) ? "same answers" : "DIFFERENT answers!") << ")\n";
+        std::filesystem::rename(snapshotPath + ".hidden", snapshotPath);
+    }
+
+    // Simulate a crash in the middle of writing a frame: garbage at the end of the log
+    {
+        std::FILE* file{ std::fopen(logPath.c_str(), "ab") };
+        std::fputs("\x12\x34half a frame", file);
+        std::fclose(file);
+
+        Leaderboard::Store store{ logPath, snapshotPath };
+        std::cout << "torn tail: cut off " << store.recoveryInfo().truncatedBytes << " bytes, "
+                  << (sameAnswers(store) ? "same answers" : "DIFFERENT answers!") << '\n';
+    }
+
+    std::filesystem::remove(logPath);
+    std::filesystem::remove(snapshotPath);
+    return 0;
+}
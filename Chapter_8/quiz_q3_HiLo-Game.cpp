@@ -1,8 +1,12 @@
+#include <chrono>
 #include <iostream>
+#include <string>
 #include "Random.h" // Header files don't use angel brackets
+#include "leaderboard.h"
 
 bool playAgain();
-bool playHiLo(int guessLimit, int min, int max)
+// Returns the number of guesses it took, or 0 if all guesses were used up
+int playHiLo(int guessLimit, int min, int max)
 {
     const int randNum{Random::get(min, max)};
     int num{1};
@@ -29,12 +33,12 @@ bool playHiLo(int guessLimit, int min, int max)
         else if (answer == randNum)
         {
             std::cout << "Great Job!\n";
-            return true;
+            return num;
         }
     }
     // Once it exits the while loop: return after saying the correct answer
     std::cout << "Sorry the answer is: " << randNum << '\n';
-    return true;
+    return 0;
 }
 
 bool playAgain()
@@ -60,11 +64,26 @@ int main()
     constexpr int min{1};
     constexpr int max{100};
 
-    // playHiLo(numGuesses, min, max);
+    // Results are kept in hilo_scores.log (see leaderboard.h)
+    Leaderboard::Store scores{ "hilo_scores.log", "hilo_scores.snap", 1 };
+    std::cout << "What's your name? ";
+    std::string name{};
+    std::cin >> name;
+    const std::uint32_t player{ scores.playerId(name) };
 
     // Got to use a do-while
     do
     {
-        playHiLo(numGuesses, min, max);
+        const int guesses{ playHiLo(numGuesses, min, max) };
+        const int score{ Leaderboard::hiLoScore(guesses > 0, guesses, numGuesses) };
+        const auto now{ std::chrono::system_clock::now().time_since_epoch() };
+        scores.record(player, score, std::chrono::duration_cast<std::chrono::seconds>(now).count());
+
+        std::cout << "Score: " << score << " (percentile " << scores.percentileOf(score) << " of all games). Your best: "
+                  << scores.best(player) << '\n';
+        for (const Leaderboard::Entry& entry : scores.top(3))
+            std::cout << "  " << entry.name << ' ' << entry.score << '\n';
     } while (playAgain());
+
+    scores.saveSnapshot();
 }
\ No newline at end of file
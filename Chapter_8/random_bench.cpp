@@ -0,0 +1,449 @@
+// Checks and benchmarks for the extra functions in Random.h.
+//
+// The checks use a chi-square test: count how often each outcome happens, and add up
+// (observed - expected)^2 / expected over all outcomes. For a fair generator the total comes out
+// close to the number of outcomes minus one ("degrees of freedom"); a biased one gives a much
+// bigger number. Anything under about dof + 4 * sqrt(2 * dof) is fine.
+//
+// Build with -O2.
+
+#include <algorithm> // for std::shuffle, std::sample, std::next_permutation, std::sort, std::clamp
+#include <array>
+#include <chrono>
+#include <cmath>   // for std::sqrt, std::erfc, std::exp, std::pow
+#include <cstddef>
+#include <cstdint>
+#include <iomanip> // for std::setw
+#include <iostream>
+#include <iterator> // for std::back_inserter
+#include <numeric>  // for std::iota
+#include <random>
+#include <stdexcept> // for std::invalid_argument
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Random.h"
+
+double g_sink{}; // results go here so the optimizer can't throw the loops away
+
+template <typename Fn>
+double seconds(Fn fn)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    fn();
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    return elapsed.count();
+}
+
+double chiSquare(const std::vector<double>& observed, const std::vector<double>& expected)
+{
+    double total{ 0.0 };
+    for (std::size_t i{ 0 }; i < observed.size(); ++i)
+    {
+        if (expected[i] > 0.0) // skip bins that can't happen (like below 0 for uniform01)
+            total += (observed[i] - expected[i]) * (observed[i] - expected[i]) / expected[i];
+    }
+    return total;
+}
+
+void printCheck(std::string_view name, double chi, std::size_t outcomes)
+{
+    const double dof{ static_cast<double>(outcomes - 1) };
+    const bool ok{ chi < dof + 4.0 * std::sqrt(2.0 * dof) };
+    std::cout << std::setw(28) << name << "  chi-square " << std::setw(9) << chi << " for " << dof << " dof  "
+              << (ok ? "ok" : "SUSPICIOUS") << '\n';
+}
+
+void printSpeed(std::string_view name, double oursSeconds, double stdSeconds, std::string_view stdName)
+{
+    std::cout << std::setw(28) << name << std::setw(10) << oursSeconds * 1e3 << " ms   vs " << stdName << ' '
+              << stdSeconds * 1e3 << " ms  (" << stdSeconds / oursSeconds << "x)\n";
+}
+
+void checkSampling()
+{
+    std::cout << "Checks\n";
+    std::mt19937 engine{ 1 };
+
+    // Shuffling 4 elements: each of the 24 orders should be equally likely
+    {
+        constexpr int trials{ 2'400'000 };
+        std::vector<double> observed(24);
+        for (int t{ 0 }; t < trials; ++t)
+        {
+            std::array<int, 4> a{ 0, 1, 2, 3 };
+            Random::shuffle(a.begin(), a.end(), engine);
+            // Number the permutation by counting how many next_permutation steps it is from sorted
+            std::array<int, 4> p{ 0, 1, 2, 3 };
+            std::size_t index{ 0 };
+            while (p != a)
+            {
+                std::next_permutation(p.begin(), p.end());
+                ++index;
+            }
+            ++observed[index];
+        }
+        printCheck("shuffle, 4! orders", chiSquare(observed, std::vector<double>(24, trials / 24.0)), 24);
+    }
+
+    // Large shuffles use both code paths (one and two positions per draw): check every element
+    // is equally likely to land in the middle slot
+    {
+        constexpr int trials{ 20'000 };
+        constexpr std::size_t n{ 70'000 };
+        constexpr std::size_t buckets{ 100 };
+        std::vector<double> observed(buckets);
+        std::vector<int> a(n);
+        for (int t{ 0 }; t < trials; ++t)
+        {
+            std::iota(a.begin(), a.end(), 0);
+            Random::shuffle(a.begin(), a.end(), engine);
+            ++observed[static_cast<std::size_t>(a[n / 2]) * buckets / n];
+        }
+        printCheck("shuffle 70000, middle slot", chiSquare(observed, std::vector<double>(buckets, trials / double{ buckets })), buckets);
+    }
+
+    // sample 10 of 100 (Floyd's algorithm path) and 60 of 100 (partial shuffle path): every element equally often
+    for (std::size_t k : { std::size_t{ 10 }, std::size_t{ 60 } })
+    {
+        constexpr int trials{ 100'000 };
+        std::vector<double> observed(100);
+        for (int t{ 0 }; t < trials; ++t)
+            for (std::size_t index : Random::sampleIndices(100, k, engine))
+                ++observed[index];
+        printCheck(k == 10 ? "sampleIndices 10 of 100" : "sampleIndices 60 of 100",
+                   chiSquare(observed, std::vector<double>(100, trials * static_cast<double>(k) / 100.0)), 100);
+    }
+
+    // Reservoir of 10 from a stream of 1000: every item equally likely to end up in it
+    {
+        constexpr int trials{ 20'000 };
+        std::vector<double> observed(1000);
+        for (int t{ 0 }; t < trials; ++t)
+        {
+            Random::Reservoir<int> reservoir{ 10, engine };
+            for (int i{ 0 }; i < 1000; ++i)
+                reservoir.add(i);
+            for (int item : reservoir.items())
+                ++observed[static_cast<std::size_t>(item)];
+        }
+        printCheck("Reservoir 10 of 1000", chiSquare(observed, std::vector<double>(1000, trials * 10.0 / 1000.0)), 1000);
+    }
+
+    // Weighted draws follow the weights
+    {
+        const std::vector<double> weights{ 1, 2, 3, 4, 0.5, 10, 0.25, 7 };
+        const Random::WeightedSampler sampler{ weights };
+        constexpr int draws{ 1'000'000 };
+        std::vector<double> observed(weights.size());
+        for (int d{ 0 }; d < draws; ++d)
+            ++observed[sampler(engine)];
+        double total{ 0.0 };
+        for (double w : weights)
+            total += w;
+        std::vector<double> expected{};
+        for (double w : weights)
+            expected.push_back(draws * w / total);
+        printCheck("WeightedSampler, 8 weights", chiSquare(observed, expected), weights.size());
+    }
+
+    // Ranges past 2^32 (only reachable with arrays of over 4 billion elements): 3 * 2^32 + 5, looked
+    // at in 6 equal slices, plus the tiny last slice, so a cast down to 32 bits would show at once
+    {
+        constexpr std::size_t range{ 3 * (std::size_t{ 1 } << 32) + 5 };
+        constexpr int draws{ 600'000 };
+        std::vector<double> observed(6);
+        std::mt19937 wide{ 4 }; // its own engine, so this check doesn't depend on how many draws came before
+        for (int d{ 0 }; d < draws; ++d)
+        {
+            const std::size_t x{ Random::boundedIndex(range, wide) };
+            if (x < range - 5)
+                ++observed[x / ((range - 5) / 6)];
+        }
+        printCheck("boundedIndex, 3 * 2^32 + 5", chiSquare(observed, std::vector<double>(6, draws / 6.0)), 6);
+    }
+
+    // Edge cases that must not crash: an empty reservoir, and weights that can't be sampled
+    {
+        Random::Reservoir<int> none{ 0, engine };
+        for (int i{ 0 }; i < 100; ++i)
+            none.add(i);
+        int rejected{ 0 };
+        for (const std::vector<double>& bad : { std::vector<double>{}, { 0.0, 0.0 }, { 1.0, -1.0, 2.0 }, { std::nan("") } })
+        {
+            try
+            {
+                const Random::WeightedSampler sampler{ bad };
+            }
+            catch (const std::invalid_argument&)
+            {
+                ++rejected;
+            }
+        }
+        std::cout << std::setw(28) << "k = 0 reservoir, bad weights" << "  " << (none.items().empty() && none.seen() == 100 && rejected == 4 ? "ok" : "WRONG")
+                  << '\n';
+    }
+    std::cout << '\n';
+}
+
+void benchmarkSampling()
+{
+    std::cout << "Speed\n";
+    std::mt19937 engine{ 2 };
+
+    // One big shuffle
+    {
+        std::vector<int> a(10'000'000);
+        std::iota(a.begin(), a.end(), 0);
+        const double ours{ seconds([&] { Random::shuffle(a.begin(), a.end(), engine); }) };
+        const double theirs{ seconds([&] { std::shuffle(a.begin(), a.end(), engine); }) };
+        printSpeed("shuffle 10M ints", ours, theirs, "std::shuffle");
+    }
+
+    // Lots of small shuffles (both positions of each pair come from one random number here)
+    {
+        std::vector<int> a(1000);
+        std::iota(a.begin(), a.end(), 0);
+        constexpr int rounds{ 10'000 };
+        const double ours{ seconds([&] { for (int r{ 0 }; r < rounds; ++r) Random::shuffle(a.begin(), a.end(), engine); }) };
+        const double theirs{ seconds([&] { for (int r{ 0 }; r < rounds; ++r) std::shuffle(a.begin(), a.end(), engine); }) };
+        printSpeed("10000 x shuffle 1000 ints", ours, theirs, "std::shuffle");
+    }
+
+    // 1000 of 10 million
+    {
+        std::vector<int> a(10'000'000);
+        std::iota(a.begin(), a.end(), 0);
+        constexpr int rounds{ 20 };
+        long long sink{ 0 };
+        const double ours{ seconds([&] {
+            for (int r{ 0 }; r < rounds; ++r)
+                sink += Random::sample(a.begin(), a.end(), 1000, engine)[0];
+        }) };
+        const double theirs{ seconds([&] {
+            for (int r{ 0 }; r < rounds; ++r)
+            {
+                std::vector<int> out{};
+                out.reserve(1000);
+                std::sample(a.begin(), a.end(), std::back_inserter(out), 1000, engine);
+                sink += out[0];
+            }
+        }) };
+        printSpeed("20 x sample 1000 of 10M", ours, theirs, "std::sample");
+        g_sink += static_cast<double>(sink);
+    }
+
+    // Reservoir over a stream of 10 million vs drawing a random number per item (Algorithm R)
+    {
+        constexpr int streamLength{ 10'000'000 };
+        constexpr std::size_t k{ 100 };
+        Random::Reservoir<int> reservoir{ k, engine };
+        const double ours{ seconds([&] {
+            for (int i{ 0 }; i < streamLength; ++i)
+                reservoir.add(i);
+        }) };
+
+        std::vector<int> simple{};
+        const double theirs{ seconds([&] {
+            for (int i{ 0 }; i < streamLength; ++i)
+            {
+                if (simple.size() < k)
+                    simple.push_back(i);
+                else if (const std::size_t j{ std::uniform_int_distribution<std::size_t>{ 0, static_cast<std::size_t>(i) }(engine) }; j < k)
+                    simple[j] = i;
+            }
+        }) };
+        printSpeed("Reservoir 100 of 10M", ours, theirs, "one draw per item");
+    }
+
+    // 10 million weighted draws from 1000 weights
+    {
+        std::vector<double> weights(1000);
+        for (std::size_t i{ 0 }; i < weights.size(); ++i)
+            weights[i] = 1.0 + static_cast<double>(i % 37);
+        const Random::WeightedSampler sampler{ weights };
+        std::discrete_distribution<std::size_t> discrete{ weights.begin(), weights.end() };
+
+        constexpr int draws{ 10'000'000 };
+        std::size_t sink{ 0 };
+        const double ours{ seconds([&] { for (int d{ 0 }; d < draws; ++d) sink += sampler(engine); }) };
+        const double theirs{ seconds([&] { for (int d{ 0 }; d < draws; ++d) sink += discrete(engine); }) };
+        printSpeed("10M weighted draws (1000)", ours, theirs, "std::discrete_distribution");
+        g_sink += static_cast<double>(sink);
+    }
+    std::cout << '\n';
+}
+
+// Chi-square over histogram bins, with the expected share of each bin from the distribution's CDF.
+// bins: edges[0] < edges[1] < ...; everything below edges[0] and above edges.back() gets its own bin too.
+template <typename Draw, typename Cdf>
+double histogramCheck(Draw draw, Cdf cdf, double lo, double hi, std::size_t numBins, int samples, std::size_t& outcomes)
+{
+    std::vector<double> observed(numBins + 2);
+    const double width{ (hi - lo) / static_cast<double>(numBins) };
+    for (int n{ 0 }; n < samples; ++n)
+    {
+        const double x{ draw() };
+        if (x < lo)
+            ++observed[0];
+        else if (x >= hi)
+            ++observed[numBins + 1];
+        else
+            ++observed[1 + std::min(numBins - 1, static_cast<std::size_t>((x - lo) / width))];
+    }
+    std::vector<double> expected(numBins + 2);
+    expected[0] = cdf(lo) * samples;
+    for (std::size_t b{ 0 }; b < numBins; ++b)
+        expected[b + 1] = (cdf(lo + width * static_cast<double>(b + 1)) - cdf(lo + width * static_cast<double>(b))) * samples;
+    expected[numBins + 1] = (1.0 - cdf(hi)) * samples;
+    outcomes = observed.size();
+    return chiSquare(observed, expected);
+}
+
+// Kolmogorov-Smirnov: the biggest gap between the sample's CDF and the real one, times sqrt(n).
+// Under about 1.95 is fine (the 0.1% level).
+template <typename Draw, typename Cdf>
+double ksStatistic(Draw draw, Cdf cdf, std::size_t samples)
+{
+    std::vector<double> xs(samples);
+    for (double& x : xs)
+        x = draw();
+    std::sort(xs.begin(), xs.end());
+    double d{ 0.0 };
+    for (std::size_t i{ 0 }; i < samples; ++i)
+    {
+        const double f{ cdf(xs[i]) };
+        d = std::max({ d, f - static_cast<double>(i) / samples, static_cast<double>(i + 1) / samples - f });
+    }
+    return d * std::sqrt(static_cast<double>(samples));
+}
+
+struct Moments
+{
+    double mean{};
+    double variance{};
+    double skewness{};
+    double kurtosis{};
+};
+
+template <typename Draw>
+Moments moments(Draw draw, int samples)
+{
+    double s1{ 0.0 };
+    double s2{ 0.0 };
+    double s3{ 0.0 };
+    double s4{ 0.0 };
+    for (int n{ 0 }; n < samples; ++n)
+    {
+        const double x{ draw() };
+        s1 += x;
+        s2 += x * x;
+        s3 += x * x * x;
+        s4 += x * x * x * x;
+    }
+    const double n{ static_cast<double>(samples) };
+    const double mean{ s1 / n };
+    const double variance{ s2 / n - mean * mean };
+    const double third{ s3 / n - 3 * mean * s2 / n + 2 * mean * mean * mean };
+    const double fourth{ s4 / n - 4 * mean * s3 / n + 6 * mean * mean * s2 / n - 3 * mean * mean * mean * mean };
+    return { mean, variance, third / std::pow(variance, 1.5), fourth / (variance * variance) };
+}
+
+double normalCdf(double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); }
+double exponentialCdf(double x) { return x <= 0.0 ? 0.0 : 1.0 - std::exp(-x); }
+
+template <typename T>
+void checkDistributions(std::string_view typeName)
+{
+    std::mt19937 engine{ 3 };
+    constexpr int samples{ 10'000'000 };
+    std::size_t outcomes{};
+    const std::string suffix{ "<" + std::string{ typeName } + ">" };
+
+    // uniform01 must stay inside [0, 1)
+    T lowest{ 1 };
+    T highest{ 0 };
+    for (int n{ 0 }; n < samples; ++n)
+    {
+        const T x{ Random::uniform01<T>(engine) };
+        lowest = std::min(lowest, x);
+        highest = std::max(highest, x);
+    }
+    std::cout << std::setw(28) << ("uniform01" + suffix) << "  range [" << lowest << ", 1 - " << 1 - highest << "]  "
+              << (lowest >= 0 && highest < 1 ? "ok" : "OUT OF RANGE") << '\n';
+    const double uniformChi{ histogramCheck([&] { return static_cast<double>(Random::uniform01<T>(engine)); },
+                                            [](double x) { return std::clamp(x, 0.0, 1.0); }, 0.0, 1.0, 1000, samples, outcomes) };
+    printCheck("uniform01" + suffix + " histogram", uniformChi, outcomes - 2); // the two outside bins are always empty
+
+    // Normal: moments, histogram out to the far tails, and KS
+    const Moments m{ moments([&] { return static_cast<double>(Random::normal<T>(engine)); }, samples) };
+    std::cout << std::setw(28) << ("normal" + suffix + " moments") << "  mean " << m.mean << ", variance " << m.variance
+              << ", skewness " << m.skewness << ", kurtosis " << m.kurtosis << "  (want 0, 1, 0, 3)\n";
+    const double normalChi{ histogramCheck([&] { return static_cast<double>(Random::normal<T>(engine)); }, normalCdf, -4.5, 4.5, 180, samples, outcomes) };
+    printCheck("normal" + suffix + " histogram", normalChi, outcomes);
+    std::cout << std::setw(28) << ("normal" + suffix + " KS") << "  " << ksStatistic([&] { return static_cast<double>(Random::normal<T>(engine)); }, normalCdf, 1'000'000)
+              << "  (under 1.95 is fine)\n";
+
+    const double expChi{ histogramCheck([&] { return static_cast<double>(Random::exponential<T>(engine)); }, exponentialCdf, 0.0, 10.0, 200, samples, outcomes) };
+    printCheck("exponential" + suffix + " histogram", expChi, outcomes - 1); // nothing below 0
+    std::cout << std::setw(28) << ("exponential" + suffix + " KS") << "  "
+              << ksStatistic([&] { return static_cast<double>(Random::exponential<T>(engine)); }, exponentialCdf, 1'000'000) << "  (under 1.95 is fine)\n";
+}
+
+template <typename T>
+void benchmarkDistributions(std::string_view typeName)
+{
+    std::mt19937 engine{ 4 };
+    constexpr int draws{ 10'000'000 };
+    std::vector<T> out(draws);
+    const std::string suffix{ "<" + std::string{ typeName } + ">" };
+
+    auto loop{ [&](auto draw) {
+        return seconds([&] {
+            for (T& x : out)
+                x = draw();
+        });
+    } };
+    auto keep{ [&] { g_sink += static_cast<double>(out[draws / 2]); } };
+
+    std::uniform_real_distribution<T> uniform{ 0, 1 };
+    const double ours{ loop([&] { return Random::uniform01<T>(engine); }) };
+    keep();
+    const double theirs{ loop([&] { return uniform(engine); }) };
+    keep();
+    printSpeed("10M uniform01" + suffix, ours, theirs, "std::uniform_real_distribution");
+
+    std::normal_distribution<T> normal{ 0, 1 };
+    const double oursNormal{ loop([&] { return Random::normal<T>(engine); }) };
+    keep();
+    const double theirsNormal{ loop([&] { return normal(engine); }) };
+    keep();
+    printSpeed("10M normal" + suffix, oursNormal, theirsNormal, "std::normal_distribution");
+
+    std::exponential_distribution<T> exponential{ 1 };
+    const double oursExp{ loop([&] { return Random::exponential<T>(engine); }) };
+    keep();
+    const double theirsExp{ loop([&] { return exponential(engine); }) };
+    keep();
+    printSpeed("10M exponential" + suffix, oursExp, theirsExp, "std::exponential_distribution");
+
+    const double batch{ seconds([&] { Random::fillNormal(out.begin(), out.end(), T{ 0 }, T{ 1 }, engine); }) };
+    keep();
+    printSpeed("fillNormal 10M" + suffix, batch, oursNormal, "one normal() at a time");
+}
+
+int main()
+{
+    checkSampling();
+    benchmarkSampling();
+
+    std::cout << "Distribution checks\n";
+    checkDistributions<double>("double");
+    checkDistributions<float>("float");
+    std::cout << "\nDistribution speed\n";
+    benchmarkDistributions<double>("double");
+    benchmarkDistributions<float>("float");
+    std::cout << '\n';
+    std::cout << "(checksum " << g_sink << ")\n";
+    return 0;
+}